@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : num_frames_(num_frames), nodes_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (t1_.empty() && t2_.empty()) {
+    return false;
+  }
+  const bool from_t1 = EvictFromT1();
+  auto &frames = from_t1 ? t1_ : t2_;
+  *frame_id = std::get<2>(*frames.begin());
+  frames.erase(frames.begin());
+
+  auto &node = nodes_[*frame_id];
+  if (from_t1) {
+    t1_size_--;
+    if (!node.scan_only_ && node.page_id_ != INVALID_PAGE_ID) {
+      b1_.PushBack(node.page_id_);
+    }
+  } else {
+    t2_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      b2_.PushBack(node.page_id_);
+    }
+  }
+  node = ARCNode();
+  TrimGhosts();
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  const bool scan = access_type == AccessType::Scan;
+  if (!node.tracked_) {
+    node.tracked_ = true;
+    node.last_access_ = current_timestamp_++;
+    const page_id_t page_id = scan ? INVALID_PAGE_ID : node.page_id_;
+    if (page_id != INVALID_PAGE_ID && b1_.Contains(page_id)) {
+      // T1 was too small to keep this page until its second access.
+      p_ = std::min(num_frames_, p_ + std::max<size_t>(b2_.Size() / b1_.Size(), 1));
+      b1_.Erase(page_id);
+      node.list_ = List::T2;
+      t2_size_++;
+    } else if (page_id != INVALID_PAGE_ID && b2_.Contains(page_id)) {
+      // T2 was too small to keep this frequently used page.
+      const size_t delta = std::max<size_t>(b1_.Size() / b2_.Size(), 1);
+      p_ = p_ > delta ? p_ - delta : 0;
+      b2_.Erase(page_id);
+      node.list_ = List::T2;
+      t2_size_++;
+    } else {
+      node.list_ = List::T1;
+      node.scan_only_ = scan;
+      t1_size_++;
+    }
+    TrimGhosts();
+    return;
+  }
+  if (scan) {
+    return;
+  }
+  if (node.is_evictable_) {
+    EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  }
+  if (node.list_ == List::T1) {
+    t1_size_--;
+    t2_size_++;
+    node.list_ = List::T2;
+  }
+  node.scan_only_ = false;
+  node.last_access_ = current_timestamp_++;
+  if (node.is_evictable_) {
+    EvictionSetOf(node).insert(EvictionKeyOf(frame_id));
+  }
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > num_frames_) {
+    b1_.PopFront();
+  }
+  while (b2_.Size() > 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * num_frames_) {
+    b2_.PopFront();
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_ || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictionSetOf(node).insert(EvictionKeyOf(frame_id));
+  } else {
+    EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a non-evictable frame");
+  EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  if (node.list_ == List::T1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  node = ARCNode();
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return t1_.size() + t2_.size();
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // Which list goes first changes as frames are evicted; this uses the list the next victim comes from.
+  std::vector<frame_id_t> candidates;
+  const bool t1_first = EvictFromT1();
+  for (auto *frames : {t1_first ? &t1_ : &t2_, t1_first ? &t2_ : &t1_}) {
+    for (auto it = frames->begin(); it != frames->end() && candidates.size() < max_candidates; ++it) {
+      candidates.push_back(std::get<2>(*it));
+    }
+  }
+  return candidates;
+}
+
+void ARCReplacer::Resize(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  for (size_t i = num_frames; i < nodes_.size(); i++) {
+    BUSTUB_ASSERT(!nodes_[i].tracked_, "cannot drop a tracked frame");
+  }
+  nodes_.resize(num_frames);
+  num_frames_ = num_frames;
+  p_ = std::min(p_, num_frames_);
+  TrimGhosts();
+}
+
+void ARCReplacer::SetFramePage(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  nodes_[frame_id].page_id_ = page_id;
+}
+
+}  // namespace bustub
@@ -12,155 +12,930 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <future>  // NOLINT
+#include <unordered_set>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+                                                     LogManager *log_manager, ReplacementPolicy replacement_policy,
+                                                     size_t max_pool_size, size_t compressed_cache_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacement_policy,
+                                max_pool_size, compressed_cache_size) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacementPolicy replacement_policy,
+                                                     size_t max_pool_size, size_t compressed_cache_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_frames_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  // we allocate a consecutive memory space for the buffer pool, page-aligned so that frames can take direct I/O, and
+  // reserve it for the largest size up front so that growing never moves a frame
+  frame_memory_ = std::make_unique<FrameMemory>(pool_size, max_pool_size_);
+  pages_ = new Page[max_pool_size_];
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = frame_memory_->FrameData(static_cast<frame_id_t>(i));
+  }
+  frames_ = std::make_unique<FrameHeader[]>(max_pool_size_);
+  replacer_ = MakeReplacer(replacement_policy, pool_size, replacer_k);
+  if (compressed_cache_size > 0) {
+    compressed_cache_ = std::make_unique<CompressedPageCache>(compressed_cache_size);
+  }
 
   // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
+  for (size_t i = 0; i < pool_size; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
-
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopWarmup();
+  StopPageDumper();
+  StopPageCleaner();
+  {
+    std::scoped_lock lock(latch_);
+    prefetch_running_ = false;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+  }
   delete[] pages_;
-  delete page_table_;
-  delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::scoped_lock lock{latch_};
-  frame_id_t fid;
-  if(!free_list_.empty()){
-    fid = free_list_.front();
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *frame_lock) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
     free_list_.pop_front();
-  }else if(!replacer_->Evict(&fid)){
+    *frame_lock = std::unique_lock(frames_[*frame_id].latch_);
+    return true;
+  }
+  while (replacer_->Evict(frame_id)) {
+    if (static_cast<size_t>(*frame_id) >= pool_size_) {
+      // The frame is being emptied by Resize, which takes care of its page. It is out of the replacer now, and no
+      // page is placed in it anymore.
+      continue;
+    }
+    *frame_lock = std::unique_lock(frames_[*frame_id].latch_);
+    Page *page = &pages_[*frame_id];
+    if (page->pin_count_ == 0) {
+      // The replacer may track the frame again if it was pinned and unpinned since it was evicted.
+      replacer_->Remove(*frame_id);
+      return true;
+    }
+    // PinResident got to the frame first. Make sure the replacer tracks it, so that it becomes evictable again once
+    // it is unpinned.
+    replacer_->SetFramePage(*frame_id, page->page_id_);
+    replacer_->RecordAccess(*frame_id);
+    replacer_->SetEvictable(*frame_id, false);
+    frame_lock->unlock();
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::AssignFrame(frame_id_t frame_id, page_id_t page_id, AccessType access_type,
+                                            page_id_t *victim_page_id, bool *victim_dirty) {
+  Page *page = &pages_[frame_id];
+  *victim_page_id = INVALID_PAGE_ID;
+  *victim_dirty = false;
+  if (page->page_id_ != INVALID_PAGE_ID) {
+    page_table_.Remove(page->page_id_);
+    *victim_dirty = page->is_dirty_;
+    if (*victim_dirty || compressed_cache_ != nullptr) {
+      *victim_page_id = page->page_id_;
+      writeback_[page->page_id_] = frame_id;
+    }
+    if (*victim_dirty) {
+      // The page cleaner did not keep up, let it start its next round right away.
+      foreground_writebacks_++;
+      cleaner_cv_.notify_one();
+    }
+  }
+  page_table_.Insert(page_id, frame_id);
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  frames_[frame_id].state_ = *victim_page_id != INVALID_PAGE_ID ? FrameState::WRITING_BACK : FrameState::LOADING;
+  frames_[frame_id].warm_ = false;
+
+  replacer_->SetFramePage(frame_id, page_id);
+  replacer_->RecordAccess(frame_id, access_type);
+  replacer_->SetEvictable(frame_id, false);
+}
+
+void BufferPoolManagerInstance::WriteBackVictim(frame_id_t frame_id, page_id_t victim_page_id, bool victim_dirty) {
+  if (victim_dirty) {
+    FlushLogUpTo(pages_[frame_id].GetLSN());
+    disk_manager_->WritePage(victim_page_id, pages_[frame_id].GetData());
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Insert(victim_page_id, pages_[frame_id].GetData());
+  }
+  FinishWriteBack(frame_id, victim_page_id);
+}
+
+void BufferPoolManagerInstance::ReadPage(page_id_t page_id, char *page_data) {
+  if (compressed_cache_ == nullptr || !compressed_cache_->Lookup(page_id, page_data)) {
+    disk_manager_->ReadPage(page_id, page_data);
+  }
+}
+
+void BufferPoolManagerInstance::FinishWriteBack(frame_id_t frame_id, page_id_t victim_page_id) {
+  {
+    std::scoped_lock lock(latch_);
+    writeback_.erase(victim_page_id);
+  }
+  // Wake up the fetchers of the evicted page, it is safe to read it from disk again.
+  writeback_done_.notify_all();
+  std::scoped_lock frame_lock(frames_[frame_id].latch_);
+  frames_[frame_id].state_ = FrameState::LOADING;
+}
+
+auto BufferPoolManagerInstance::PinResident(page_id_t page_id, AccessType access_type, frame_id_t *frame_id) -> bool {
+  if (!page_table_.Find(page_id, *frame_id)) {
+    return false;
+  }
+  std::scoped_lock frame_lock(frames_[*frame_id].latch_);
+  Page *page = &pages_[*frame_id];
+  // The page may have been evicted between the lookup and taking the frame's latch.
+  if (page->page_id_ != page_id) {
+    return false;
+  }
+  page->pin_count_++;
+  frames_[*frame_id].warm_ = false;
+  replacer_->RecordAccess(*frame_id, access_type);
+  replacer_->SetEvictable(*frame_id, false);
+  hits_[static_cast<size_t>(access_type)]++;
+  return true;
+}
+
+void BufferPoolManagerInstance::WaitUntilResident(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  std::unique_lock frame_lock(frame.latch_);
+  frame.io_done_.wait(frame_lock, [&frame] { return frame.state_ == FrameState::RESIDENT; });
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  {
+    std::scoped_lock frame_lock(frame.latch_);
+    frame.state_ = FrameState::RESIDENT;
+  }
+  frame.io_done_.notify_all();
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { return NewPgImp(page_id, INVALID_PAGE_ID); }
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * {
+  // Allocating the page id may write the free space map, so it is done before taking latch_ and given back if there
+  // is no frame for the page.
+  const page_id_t new_page_id = AllocatePage(near_page_id);
+  std::unique_lock lock(latch_);
+  frame_id_t frame_id;
+  std::unique_lock<std::mutex> frame_lock;
+  if (!AcquireFrame(&frame_id, &frame_lock)) {
+    lock.unlock();
+    DeallocatePage(new_page_id);
     return nullptr;
   }
+  page_id_t victim_page_id;
+  bool victim_dirty;
+  AssignFrame(frame_id, new_page_id, AccessType::Unknown, &victim_page_id, &victim_dirty);
+  frame_lock.unlock();
+  lock.unlock();
 
-  Page *p = &pages_[fid];
-  if(p->is_dirty_){
-    disk_manager_->WritePage(p->page_id_, p->GetData());
-  }
-  page_table_->Remove(p->page_id_);
-  //reset
-  *page_id = AllocatePage();
-  p->pin_count_ = 1;
-  p->page_id_ = *page_id;
-  p->is_dirty_ = false;
-  page_table_->Insert(*page_id , fid);
-  
-  replacer_->RecordAccess(fid);
-  replacer_->SetEvictable(fid , false);
-  //???
-  disk_manager_->WritePage(p->page_id_, p->GetData());
-  return p;
-}
-
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t pid) -> Page * {
-  if(pid == INVALID_PAGE_ID) return nullptr;
-  std::scoped_lock lock{latch_};
-  
-  frame_id_t fid;
-  if(page_table_->Find(pid , fid)){
-    
-    replacer_->RecordAccess(fid);
-    
-    replacer_->SetEvictable(fid , false);
-    pages_[fid].pin_count_++;
-    return &pages_[fid];
-  }
-  //
-  if(!free_list_.empty()){
-    fid = free_list_.front();
-    free_list_.pop_front();
-  }else if(!replacer_->Evict(&fid)){
+  Page *page = &pages_[frame_id];
+  if (victim_page_id != INVALID_PAGE_ID) {
+    WriteBackVictim(frame_id, victim_page_id, victim_dirty);
+  }
+  page->ResetMemory();
+  // Write the zeroed page out right away so that the page exists on disk even if it is evicted before it is dirtied.
+  disk_manager_->WritePage(new_page_id, page->GetData());
+
+  FinishIo(frame_id);
+  *page_id = new_page_id;
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgImp(page_id, AccessType::Unknown);
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
     return nullptr;
   }
-  Page *p = &pages_[fid];
-  page_table_->Insert(pid , fid);
-  
-  p->pin_count_ = 1;
-  p->page_id_ = pid;
-  p->is_dirty_ = false;
-  disk_manager_->ReadPage(pid, p->GetData());
-  replacer_->RecordAccess(fid);
-  replacer_->SetEvictable(fid , false);
-  return p;
+  ValidatePageId(page_id);
+  // Hit path: no latch_. If somebody else is still bringing the page in, wait for that read instead of issuing a
+  // second one.
+  frame_id_t frame_id;
+  if (PinResident(page_id, access_type, &frame_id)) {
+    WaitUntilResident(frame_id);
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock lock(latch_);
+  while (true) {
+    // Look again, the page may have been brought in since. With latch_ held it cannot be evicted in between.
+    if (PinResident(page_id, access_type, &frame_id)) {
+      lock.unlock();
+      WaitUntilResident(frame_id);
+      return &pages_[frame_id];
+    }
+    if (writeback_.count(page_id) == 0) {
+      break;
+    }
+    // The page was just evicted and its dirty contents are still on the way to disk. Wait for the write, then look
+    // the page up again.
+    writeback_done_.wait(lock, [this, page_id] { return writeback_.count(page_id) == 0; });
+  }
+
+  std::unique_lock<std::mutex> frame_lock;
+  if (!AcquireFrame(&frame_id, &frame_lock)) {
+    return nullptr;
+  }
+  page_id_t victim_page_id;
+  bool victim_dirty;
+  AssignFrame(frame_id, page_id, access_type, &victim_page_id, &victim_dirty);
+  misses_[static_cast<size_t>(access_type)]++;
+  frame_lock.unlock();
+  lock.unlock();
+
+  Page *page = &pages_[frame_id];
+  if (victim_page_id != INVALID_PAGE_ID) {
+    WriteBackVictim(frame_id, victim_page_id, victim_dirty);
+  }
+  ReadPage(page_id, page->GetData());
+
+  FinishIo(frame_id);
+  return page;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::scoped_lock lock{latch_};
-  frame_id_t fid;
-  if(!page_table_->Find(page_id,fid)){
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, frame_id)) {
     return false;
   }
-  Page *p = &pages_[fid];
-  if(p->pin_count_ <= 0){
+  std::scoped_lock frame_lock(frames_[frame_id].latch_);
+  Page *page = &pages_[frame_id];
+  if (page->page_id_ != page_id || page->pin_count_ <= 0) {
     return false;
   }
-  if(is_dirty){
-    p->is_dirty_ = true;
+  if (is_dirty) {
+    page->is_dirty_ = true;
   }
-  if(--(p->pin_count_) == 0){
-    replacer_->SetEvictable(fid , true);
+  if (--page->pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      frame_unpinned_.notify_all();
+    }
   }
   return true;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock lock{latch_};
-  frame_id_t fid;
-  if(!page_table_->Find(page_id,fid) || page_id == INVALID_PAGE_ID){
+  if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  Page *p = &pages_[fid];
-  disk_manager_->WritePage(page_id, p->GetData());
-  p->is_dirty_ = false;
+  std::unique_lock lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, frame_id)) {
+    return false;
+  }
+  FlushFrame(&lock, frame_id);
   return true;
 }
 
+void BufferPoolManagerInstance::FlushFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  FlushFrames(lock, {frame_id});
+}
+
+void BufferPoolManagerInstance::FlushFrames(std::unique_lock<std::mutex> *lock,
+                                            const std::vector<frame_id_t> &frame_ids) {
+  PinForFlush(frame_ids);
+  lock->unlock();
+  disk_manager_->WritePages(ClaimForFlush(frame_ids));
+  UnpinAfterFlush(frame_ids);
+  lock->lock();
+}
+
+void BufferPoolManagerInstance::PinForFlush(const std::vector<frame_id_t> &frame_ids) {
+  for (auto frame_id : frame_ids) {
+    std::scoped_lock frame_lock(frames_[frame_id].latch_);
+    pages_[frame_id].pin_count_++;
+    replacer_->SetEvictable(frame_id, false);
+  }
+}
+
+auto BufferPoolManagerInstance::ClaimForFlush(const std::vector<frame_id_t> &frame_ids)
+    -> std::vector<std::pair<page_id_t, const char *>> {
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  batch.reserve(frame_ids.size());
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto frame_id : frame_ids) {
+    Page *page = &pages_[frame_id];
+    auto &frame = frames_[frame_id];
+    std::unique_lock frame_lock(frame.latch_);
+    frame.io_done_.wait(frame_lock, [&frame] { return frame.state_ == FrameState::RESIDENT; });
+    // Clear the dirty flag before writing: if the page is modified while we write, the modification sets it again.
+    page->is_dirty_ = false;
+    batch.emplace_back(page->page_id_, page->GetData());
+    // A page that is not logged may hold any number at OFFSET_LSN, which must not hide the LSNs of the others.
+    if (IsHandedOut(page->GetLSN())) {
+      max_lsn = std::max(max_lsn, page->GetLSN());
+    }
+  }
+  FlushLogUpTo(max_lsn);
+  return batch;
+}
+
+void BufferPoolManagerInstance::UnpinAfterFlush(const std::vector<frame_id_t> &frame_ids) {
+  for (auto frame_id : frame_ids) {
+    std::scoped_lock frame_lock(frames_[frame_id].latch_);
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+}
+
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock lock{latch_};
-  for(size_t i=0;i<pool_size_;i++){
-    disk_manager_->WritePage(pages_[i].page_id_ ,pages_[i].GetData());
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  const auto frame_ids = BeginFlushAll(&batch);
+  disk_manager_->WritePages(std::move(batch));
+  EndFlushAll(frame_ids);
+  // This is a checkpoint of the whole pool, so make it durable; a single sync covers all the writes.
+  disk_manager_->SyncPages();
+}
+
+auto BufferPoolManagerInstance::BeginFlushAll(std::vector<std::pair<page_id_t, const char *>> *batch)
+    -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> frame_ids;
+  {
+    std::scoped_lock lock(latch_);
+    // A clean page is the same on disk already, only the dirty ones need writing.
+    for (size_t i = 0; i < num_frames_; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_dirty_) {
+        frame_ids.push_back(static_cast<frame_id_t>(i));
+      }
+    }
+    PinForFlush(frame_ids);
   }
+  auto claimed = ClaimForFlush(frame_ids);
+  batch->insert(batch->end(), claimed.begin(), claimed.end());
+  return frame_ids;
+}
+
+void BufferPoolManagerInstance::EndFlushAll(const std::vector<frame_id_t> &frame_ids) {
+  UnpinAfterFlush(frame_ids);
+  std::unique_lock lock(latch_);
+  writeback_done_.wait(lock, [this] { return writeback_.empty(); });
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock lock{latch_};
-  frame_id_t fid;
-  if(!page_table_->Find(page_id,fid)){
+  if (page_id == INVALID_PAGE_ID) {
     return true;
   }
-  Page *p = &pages_[fid];
-  if(p->pin_count_ > 0){
-    return false;
+  {
+    std::unique_lock lock(latch_);
+    // An evicted copy of the page may still be on its way to disk. Its id must not be handed out again before that
+    // write is done, or the write could overwrite the new page.
+    writeback_done_.wait(lock, [this, page_id] { return writeback_.count(page_id) == 0; });
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, frame_id)) {
+      std::scoped_lock frame_lock(frames_[frame_id].latch_);
+      Page *page = &pages_[frame_id];
+      if (page->pin_count_ > 0) {
+        return false;
+      }
+      // The page is gone for good, so there is no point in writing back its dirty contents.
+      FreeFrame(frame_id);
+    }
   }
-  if(p->is_dirty_){
-    disk_manager_->WritePage(page_id, p->GetData());
+  // Free the page on disk as well, whether it was in the pool or not. This writes the free space map, so latch_ is
+  // not held.
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
   }
   DeallocatePage(page_id);
-  page_table_->Remove(page_id);
-  p->page_id_ = INVALID_PAGE_ID;
-  p->pin_count_ = 0;
-  p->is_dirty_ = false;
-  free_list_.push_back(fid);
   return true;
-  
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page_table_.Remove(page->page_id_);
+  replacer_->Remove(frame_id);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->pin_count_ = 0;
+  page->is_dirty_ = false;
+  frames_[frame_id].state_ = FrameState::FREE;
+  // A frame that Resize is emptying stays empty.
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::NewSegmentImp() -> segment_id_t { return disk_manager_->CreateSegment(); }
+
+auto BufferPoolManagerInstance::DeleteSegmentImp(segment_id_t segment) -> bool {
+  if (segment == DEFAULT_SEGMENT_ID || !disk_manager_->HasSegment(segment)) {
+    return false;
+  }
+  return DiscardSegment(segment) && disk_manager_->DeleteSegment(segment);
+}
+
+auto BufferPoolManagerInstance::DiscardSegment(segment_id_t segment) -> bool {
+  const auto in_segment = [segment](page_id_t page_id) {
+    return page_id != INVALID_PAGE_ID && DiskManager::SegmentOf(page_id) == segment;
+  };
+  {
+    std::unique_lock lock(latch_);
+    // An evicted page of the segment may still be on its way to the file that is about to go away.
+    writeback_done_.wait(lock, [this, &in_segment] {
+      return std::none_of(writeback_.begin(), writeback_.end(),
+                          [&in_segment](const auto &entry) { return in_segment(entry.first); });
+    });
+    // Frames in a transient state are pinned, so a page that is being read or written back is found here as well.
+    std::vector<frame_id_t> frame_ids;
+    for (size_t i = 0; i < num_frames_; i++) {
+      const auto frame_id = static_cast<frame_id_t>(i);
+      std::scoped_lock frame_lock(frames_[frame_id].latch_);
+      if (in_segment(pages_[frame_id].page_id_)) {
+        if (pages_[frame_id].pin_count_ > 0) {
+          return false;
+        }
+        frame_ids.push_back(frame_id);
+      }
+    }
+    for (auto frame_id : frame_ids) {
+      std::scoped_lock frame_lock(frames_[frame_id].latch_);
+      FreeFrame(frame_id);
+    }
+  }
+  if (compressed_cache_ != nullptr) {
+    const page_id_t first = DiskManager::SegmentHeaderPageId(segment);
+    compressed_cache_->EraseRange(first, first + DiskManager::PAGES_PER_SEGMENT);
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ResizeImp(size_t pool_size) -> bool {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_lock(resize_latch_);
+  std::unique_lock lock(latch_);
+  const size_t old_pool_size = pool_size_;
+  if (pool_size >= old_pool_size) {
+    // The frames are reserved already, make room for their pages and hand them out.
+    page_table_.Reserve(pool_size);
+    replacer_->Resize(pool_size);
+    for (size_t i = old_pool_size; i < pool_size; i++) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    num_frames_ = pool_size;
+    pool_size_ = pool_size;
+    return true;
+  }
+
+  // Stop placing pages in the frames that go away, then empty them.
+  pool_size_ = pool_size;
+  free_list_.remove_if([pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  EmptyRetiredFrames(&lock);
+  replacer_->Resize(pool_size);
+  num_frames_ = pool_size;
+  frame_memory_->Release(static_cast<frame_id_t>(pool_size), old_pool_size - pool_size);
+  return true;
+}
+
+void BufferPoolManagerInstance::EmptyRetiredFrames(std::unique_lock<std::mutex> *lock) {
+  while (true) {
+    std::vector<frame_id_t> dirty;
+    bool pinned = false;
+    for (size_t i = pool_size_; i < num_frames_; i++) {
+      const auto frame_id = static_cast<frame_id_t>(i);
+      std::scoped_lock frame_lock(frames_[frame_id].latch_);
+      Page *page = &pages_[frame_id];
+      if (page->page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      if (page->pin_count_ > 0) {
+        pinned = true;
+        continue;
+      }
+      if (page->is_dirty_) {
+        dirty.push_back(frame_id);
+        continue;
+      }
+      // A clean page is on disk already, drop it like an eviction does.
+      page_table_.Remove(page->page_id_);
+      replacer_->Remove(frame_id);
+      page->page_id_ = INVALID_PAGE_ID;
+      frames_[frame_id].state_ = FrameState::FREE;
+    }
+    if (!dirty.empty()) {
+      // Once written back, the pages are clean and go on the next pass.
+      FlushFrames(lock, dirty);
+      continue;
+    }
+    if (!pinned) {
+      return;
+    }
+    // UnpinPgImp signals without latch_, so a wakeup can be missed; poll as well.
+    frame_unpinned_.wait_for(*lock, std::chrono::milliseconds(1));
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPgsImp(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock lock(latch_);
+  const size_t max_in_flight = std::max<size_t>(1, pool_size_ / 4);
+  bool queued = false;
+  for (auto page_id : page_ids) {
+    if (page_id == INVALID_PAGE_ID || prefetches_in_flight_ >= max_in_flight) {
+      continue;
+    }
+    ValidatePageId(page_id);
+    frame_id_t frame_id;
+    queued = QueuePrefetch(page_id, &frame_id) || queued;
+  }
+  if (queued) {
+    WakePrefetcher();
+  }
+}
+
+auto BufferPoolManagerInstance::QueuePrefetch(page_id_t page_id, frame_id_t *frame_id) -> bool {
+  std::unique_lock<std::mutex> frame_lock;
+  if (page_table_.Find(page_id, *frame_id) || writeback_.count(page_id) > 0 || !AcquireFrame(frame_id, &frame_lock)) {
+    return false;
+  }
+  page_id_t victim_page_id;
+  bool victim_dirty;
+  // Read-ahead is speculative, so it must not push out pages that are actually in use.
+  AssignFrame(*frame_id, page_id, AccessType::Scan, &victim_page_id, &victim_dirty);
+  frame_lock.unlock();
+  prefetch_queue_.push_back({*frame_id, page_id, victim_page_id, victim_dirty});
+  prefetches_in_flight_++;
+  return true;
+}
+
+void BufferPoolManagerInstance::WakePrefetcher() {
+  if (prefetch_thread_ == nullptr) {
+    prefetch_running_ = true;
+    prefetch_thread_ = std::make_unique<std::thread>(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return !prefetch_running_ || !prefetch_queue_.empty(); });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // Take the whole queue at once and keep all of its I/O in flight together.
+    std::vector<PrefetchRequest> requests(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    lock.unlock();
+
+    std::vector<std::future<void>> writes(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      if (requests[i].victim_dirty_) {
+        FlushLogUpTo(pages_[requests[i].frame_id_].GetLSN());
+        writes[i] = disk_manager_->WritePageAsync(requests[i].victim_page_id_, pages_[requests[i].frame_id_].GetData());
+      }
+    }
+    std::vector<std::pair<page_id_t, char *>> reads;
+    reads.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      char *data = pages_[requests[i].frame_id_].GetData();
+      if (requests[i].victim_page_id_ != INVALID_PAGE_ID) {
+        if (writes[i].valid()) {
+          writes[i].get();
+        }
+        if (compressed_cache_ != nullptr) {
+          compressed_cache_->Insert(requests[i].victim_page_id_, data);
+        }
+        FinishWriteBack(requests[i].frame_id_, requests[i].victim_page_id_);
+      }
+      if (compressed_cache_ == nullptr || !compressed_cache_->Lookup(requests[i].page_id_, data)) {
+        reads.emplace_back(requests[i].page_id_, data);
+      }
+    }
+    // Read the pages as one batch, so that neighbouring pages come in with a single large read.
+    disk_manager_->ReadPages(std::move(reads));
+    prefetches_ += requests.size();
+
+    for (const auto &request : requests) {
+      const frame_id_t frame_id = request.frame_id_;
+      auto &frame = frames_[frame_id];
+      lock.lock();
+      if (--prefetches_in_flight_ == 0) {
+        prefetches_done_.notify_all();
+      }
+      {
+        std::scoped_lock frame_lock(frame.latch_);
+        frame.state_ = FrameState::RESIDENT;
+        // Drop the pin of the prefetch in the same step, so that the fetchers that waited for the read only see their
+        // own pins.
+        if (--pages_[frame_id].pin_count_ == 0) {
+          replacer_->SetEvictable(frame_id, true);
+        }
+      }
+      lock.unlock();
+      frame.io_done_.notify_all();
+    }
+    lock.lock();
+  }
+}
+
+auto BufferPoolManagerInstance::DumpResidentPages(const std::string &file_name) -> bool {
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock lock(latch_);
+    const auto candidates = replacer_->EvictionCandidates(num_frames_);
+    std::vector<bool> evictable(num_frames_, false);
+    for (auto frame_id : candidates) {
+      evictable[frame_id] = true;
+    }
+    // The pages that cannot be evicted are in use right now, the hottest of all.
+    for (size_t i = 0; i < num_frames_; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && !evictable[i]) {
+        page_ids.push_back(pages_[i].page_id_);
+      }
+    }
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+      page_ids.push_back(pages_[*it].page_id_);
+    }
+  }
+
+  const std::string tmp_file_name = file_name + ".tmp";
+  std::ofstream out(tmp_file_name, std::ios::trunc);
+  for (auto page_id : page_ids) {
+    out << page_id << '\n';
+  }
+  out.close();
+  if (!out) {
+    std::remove(tmp_file_name.c_str());
+    return false;
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+void BufferPoolManagerInstance::StartPageDumper(const std::string &file_name, std::chrono::milliseconds interval) {
+  std::scoped_lock lock(latch_);
+  if (dumper_running_) {
+    return;
+  }
+  dump_file_ = file_name;
+  dump_interval_ = interval;
+  dumper_running_ = true;
+  dumper_thread_ = std::make_unique<std::thread>(&BufferPoolManagerInstance::RunPageDumper, this);
+}
+
+void BufferPoolManagerInstance::StopPageDumper() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!dumper_running_) {
+      return;
+    }
+    dumper_running_ = false;
+  }
+  dumper_cv_.notify_one();
+  dumper_thread_->join();
+  dumper_thread_.reset();
+  DumpResidentPages(dump_file_);
+}
+
+void BufferPoolManagerInstance::RunPageDumper() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    dumper_cv_.wait_for(lock, dump_interval_, [this] { return !dumper_running_; });
+    if (!dumper_running_) {
+      return;
+    }
+    lock.unlock();
+    DumpResidentPages(dump_file_);
+    lock.lock();
+  }
+}
+
+auto BufferPoolManagerInstance::StartWarmup(const std::string &file_name) -> size_t {
+  std::ifstream in(file_name);
+  if (!in) {
+    return 0;
+  }
+  // Only the hottest pages that fit into the pool are worth reading.
+  std::vector<page_id_t> page_ids;
+  std::unordered_set<page_id_t> seen;
+  page_id_t page_id;
+  while (page_ids.size() < pool_size_ && in >> page_id) {
+    // The dump may be older than the file or come from a differently sharded pool.
+    if (page_id < 0 || page_id % num_instances_ != instance_index_ || !disk_manager_->IsPageAllocated(page_id) ||
+        !seen.insert(page_id).second) {
+      continue;
+    }
+    page_ids.push_back(page_id);
+  }
+  if (page_ids.empty()) {
+    return 0;
+  }
+  std::scoped_lock lock(latch_);
+  if (warmup_thread_ != nullptr) {
+    return 0;
+  }
+  const size_t num_pages = page_ids.size();
+  warmup_running_ = true;
+  warmup_thread_ = std::make_unique<std::thread>(&BufferPoolManagerInstance::RunWarmup, this, std::move(page_ids));
+  return num_pages;
+}
+
+void BufferPoolManagerInstance::WaitForWarmup() {
+  if (warmup_thread_ != nullptr) {
+    warmup_thread_->join();
+    warmup_thread_.reset();
+  }
+}
+
+void BufferPoolManagerInstance::StopWarmup() {
+  {
+    std::scoped_lock lock(latch_);
+    warmup_running_ = false;
+  }
+  prefetches_done_.notify_all();
+  WaitForWarmup();
+}
+
+void BufferPoolManagerInstance::RunWarmup(std::vector<page_id_t> page_ids) {
+  // Read in page id order, so that consecutive pages go to disk as one large read.
+  std::vector<page_id_t> sorted(page_ids);
+  std::sort(sorted.begin(), sorted.end());
+
+  std::unique_lock lock(latch_);
+  for (size_t next = 0; next < sorted.size();) {
+    // One chunk at a time, and only while no other read-ahead is in flight, so that the misses of the requests do
+    // not queue up behind the warm-up.
+    prefetches_done_.wait(lock, [this] { return !warmup_running_ || prefetches_in_flight_ == 0; });
+    if (!warmup_running_) {
+      return;
+    }
+    const size_t chunk_size = std::max<size_t>(1, pool_size_ / 4);
+    size_t queued = 0;
+    for (; next < sorted.size() && queued < chunk_size; next++) {
+      if (free_list_.empty()) {
+        // The pool is full, and the pages in it now were fetched since the start.
+        next = sorted.size();
+        break;
+      }
+      frame_id_t frame_id;
+      // The page may have been deleted since the dump was read.
+      if (!disk_manager_->IsPageAllocated(sorted[next]) || !QueuePrefetch(sorted[next], &frame_id)) {
+        continue;
+      }
+      std::scoped_lock frame_lock(frames_[frame_id].latch_);
+      frames_[frame_id].warm_ = true;
+      queued++;
+    }
+    if (queued > 0) {
+      warmed_pages_ += queued;
+      WakePrefetcher();
+    }
+  }
+  prefetches_done_.wait(lock, [this] { return !warmup_running_ || prefetches_in_flight_ == 0; });
+  if (!warmup_running_) {
+    return;
+  }
+
+  // The pages came in by page id, which is meaningless to the replacer. Admit the ones nobody fetched since again,
+  // coldest first, so that the replacer ranks them like it did before the restart.
+  for (auto it = page_ids.rbegin(); it != page_ids.rend(); ++it) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(*it, frame_id)) {
+      continue;
+    }
+    auto &frame = frames_[frame_id];
+    std::scoped_lock frame_lock(frame.latch_);
+    Page *page = &pages_[frame_id];
+    if (page->page_id_ != *it || !frame.warm_ || page->pin_count_ > 0 || frame.state_ != FrameState::RESIDENT) {
+      continue;
+    }
+    frame.warm_ = false;
+    replacer_->Remove(frame_id);
+    replacer_->SetFramePage(frame_id, *it);
+    replacer_->RecordAccess(frame_id);
+    replacer_->SetEvictable(frame_id, true);
+  }
+}
+
+void BufferPoolManagerInstance::StartPageCleaner(double clean_ratio, std::chrono::milliseconds interval) {
+  BUSTUB_ASSERT(clean_ratio >= 0 && clean_ratio <= 1, "clean ratio must be between 0 and 1");
+  std::scoped_lock lock(latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  clean_ratio_ = clean_ratio;
+  cleaner_interval_ = interval;
+  cleaner_running_ = true;
+  cleaner_thread_ = std::make_unique<std::thread>(&BufferPoolManagerInstance::RunPageCleaner, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_one();
+  cleaner_thread_->join();
+  cleaner_thread_.reset();
+}
+
+auto BufferPoolManagerInstance::IsLogPersistent(Page *page) -> bool {
+  return !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+}
+
+void BufferPoolManagerInstance::FlushLogUpTo(lsn_t lsn) {
+  if (enable_logging && log_manager_ != nullptr && lsn > log_manager_->GetPersistentLSN() && IsHandedOut(lsn)) {
+    log_manager_->WaitUntilPersistent(lsn);
+  }
+}
+
+auto BufferPoolManagerInstance::IsHandedOut(lsn_t lsn) -> bool {
+  // Pages that are not logged have no LSN at OFFSET_LSN. Whatever is there instead may be any number, and a number
+  // past the last LSN handed out would be waited for in vain.
+  return log_manager_ != nullptr && lsn < log_manager_->GetNextLSN();
+}
+
+auto BufferPoolManagerInstance::PickFramesToClean() -> std::vector<frame_id_t> {
+  const auto candidates = replacer_->EvictionCandidates(pool_size_);
+  // Free frames are as good as clean victims, so they count towards the target as well.
+  const size_t reclaimable = candidates.size() + free_list_.size();
+  const auto target = static_cast<size_t>(std::ceil(clean_ratio_ * static_cast<double>(reclaimable)));
+  size_t clean = free_list_.size();
+  for (auto frame_id : candidates) {
+    if (!pages_[frame_id].is_dirty_) {
+      clean++;
+    }
+  }
+
+  // Clean from the cold end, those frames are the next victims.
+  std::vector<frame_id_t> to_clean;
+  for (auto frame_id : candidates) {
+    if (clean >= target) {
+      break;
+    }
+    Page *page = &pages_[frame_id];
+    if (page->is_dirty_ && IsLogPersistent(page)) {
+      to_clean.push_back(frame_id);
+      clean++;
+    }
+  }
+  return to_clean;
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  std::unique_lock lock(latch_);
+  while (cleaner_running_) {
+    // Write back the whole round together, so that its writes are in flight at the same time.
+    const auto to_clean = PickFramesToClean();
+    if (!to_clean.empty()) {
+      FlushFrames(&lock, to_clean);
+      background_writebacks_ += to_clean.size();
+    }
+    if (cleaner_running_) {
+      cleaner_cv_.wait_for(lock, cleaner_interval_);
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::AllocatePage(page_id_t near_page_id) -> page_id_t {
+  const page_id_t page_id = disk_manager_->AllocatePage(near_page_id, num_instances_, instance_index_);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
 }  // namespace bustub
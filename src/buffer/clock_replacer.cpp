@@ -14,16 +14,104 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), nodes_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // There is an evictable frame, so this ends within two turns of the hand.
+  while (true) {
+    auto &node = nodes_[hand_];
+    const auto current = static_cast<frame_id_t>(hand_);
+    hand_ = (hand_ + 1) % num_pages_;
+    if (!node.tracked_ || !node.is_evictable_) {
+      continue;
+    }
+    if (node.referenced_) {
+      node.referenced_ = false;
+      continue;
+    }
+    *frame_id = current;
+    node = ClockNode();
+    curr_size_--;
+    return true;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (access_type == AccessType::Scan && node.tracked_) {
+    return;
+  }
+  node.referenced_ = access_type != AccessType::Scan;
+  node.tracked_ = true;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_ || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a non-evictable frame");
+  node = ClockNode();
+  curr_size_--;
+}
+
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+auto ClockReplacer::EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // The first turn of the hand evicts the unreferenced frames and clears the bits of the others, which are then
+  // evicted in the same order on the second turn.
+  std::vector<frame_id_t> candidates;
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < num_pages_ && candidates.size() < max_candidates; i++) {
+      const size_t slot = (hand_ + i) % num_pages_;
+      const auto &node = nodes_[slot];
+      if (node.tracked_ && node.is_evictable_ && node.referenced_ == referenced) {
+        candidates.push_back(static_cast<frame_id_t>(slot));
+      }
+    }
+  }
+  return candidates;
+}
+
+void ClockReplacer::Resize(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  for (size_t i = num_frames; i < nodes_.size(); i++) {
+    BUSTUB_ASSERT(!nodes_[i].tracked_, "cannot drop a tracked frame");
+  }
+  nodes_.resize(num_frames);
+  num_pages_ = num_frames;
+  if (hand_ >= num_pages_) {
+    hand_ = 0;
+  }
+}
 
 }  // namespace bustub
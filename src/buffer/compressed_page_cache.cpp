@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "storage/disk/page_codec.h"
+
+namespace bustub {
+
+namespace {
+
+auto NanosSince(std::chrono::steady_clock::time_point start) -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+auto CompressedPageCache::Insert(page_id_t page_id, const char *page_data) -> bool {
+  const auto start = std::chrono::steady_clock::now();
+  char compressed[PageCodec::MaxCompressedSize(BUSTUB_PAGE_SIZE)];
+  const size_t size = PageCodec::Compress(page_data, BUSTUB_PAGE_SIZE, compressed);
+  compress_nanos_ += NanosSince(start);
+
+  std::scoped_lock lock(latch_);
+  // An older copy is outdated either way.
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    EraseEntry(it);
+  }
+  if (size > MAX_COMPRESSED_SIZE || size > capacity_) {
+    rejections_++;
+    return false;
+  }
+  while (size_ + size > capacity_) {
+    EraseEntry(entries_.find(lru_.back()));
+    evictions_++;
+  }
+  lru_.push_front(page_id);
+  entries_.emplace(page_id, Entry{std::string(compressed, size), lru_.begin()});
+  size_ += size;
+  insertions_++;
+  return true;
+}
+
+auto CompressedPageCache::Lookup(page_id_t page_id, char *page_data) -> bool {
+  std::string compressed;
+  {
+    std::scoped_lock lock(latch_);
+    auto it = entries_.find(page_id);
+    if (it == entries_.end()) {
+      misses_++;
+      return false;
+    }
+    compressed = EraseEntry(it);
+  }
+  hits_++;
+  const auto start = std::chrono::steady_clock::now();
+  [[maybe_unused]] const bool ok =
+      PageCodec::Decompress(compressed.data(), compressed.size(), page_data, BUSTUB_PAGE_SIZE);
+  BUSTUB_ASSERT(ok, "a cached page does not decompress");
+  decompress_nanos_ += NanosSince(start);
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  if (auto it = entries_.find(page_id); it != entries_.end()) {
+    EraseEntry(it);
+  }
+}
+
+void CompressedPageCache::EraseRange(page_id_t begin, page_id_t end) {
+  std::scoped_lock lock(latch_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto current = it++;
+    if (current->first >= begin && current->first < end) {
+      EraseEntry(current);
+    }
+  }
+}
+
+auto CompressedPageCache::EraseEntry(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string {
+  std::string data = std::move(it->second.data_);
+  size_ -= data.size();
+  lru_.erase(it->second.lru_);
+  entries_.erase(it);
+  return data;
+}
+
+auto CompressedPageCache::GetSize() -> size_t {
+  std::scoped_lock lock(latch_);
+  return size_;
+}
+
+auto CompressedPageCache::GetNumPages() -> size_t {
+  std::scoped_lock lock(latch_);
+  return entries_.size();
+}
+
+}  // namespace bustub
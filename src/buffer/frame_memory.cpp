@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory.cpp
+//
+// Identification: src/buffer/frame_memory.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_memory.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+auto RoundUp(size_t size, size_t alignment) -> size_t { return (size + alignment - 1) / alignment * alignment; }
+
+}  // namespace
+
+FrameMemory::FrameMemory(size_t num_frames, size_t max_frames) {
+  const size_t bytes = std::max<size_t>({num_frames, max_frames, 1}) * BUSTUB_PAGE_SIZE;
+  if (bytes >= HUGE_PAGE_SIZE) {
+    size_ = RoundUp(bytes, HUGE_PAGE_SIZE);
+    if (max_frames <= num_frames) {
+      void *ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (ptr != MAP_FAILED) {
+        data_ = static_cast<char *>(ptr);
+        huge_page_mode_ = HugePageMode::EXPLICIT;
+        return;
+      }
+    }
+    // No huge pages are reserved. Transparent huge pages only back 2 MB-aligned ranges, so map one huge page more
+    // than needed and trim the mapping to an aligned start.
+    void *ptr = mmap(nullptr, size_ + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frames of the buffer pool");
+    }
+    const auto start = reinterpret_cast<uintptr_t>(ptr);
+    const uintptr_t aligned = RoundUp(start, HUGE_PAGE_SIZE);
+    if (aligned > start) {
+      munmap(ptr, aligned - start);
+    }
+    munmap(reinterpret_cast<void *>(aligned + size_), start + HUGE_PAGE_SIZE - aligned);
+    data_ = reinterpret_cast<char *>(aligned);
+    if (madvise(data_, size_, MADV_HUGEPAGE) == 0) {
+      huge_page_mode_ = HugePageMode::TRANSPARENT;
+    }
+    return;
+  }
+
+  size_ = bytes;
+  void *ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (ptr == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frames of the buffer pool");
+  }
+  data_ = static_cast<char *>(ptr);
+}
+
+void FrameMemory::Release(frame_id_t first_frame_id, size_t num_frames) {
+  // Explicit huge pages can only be released whole, the frames that share one with frames in use keep their memory.
+  const size_t granularity = huge_page_mode_ == HugePageMode::EXPLICIT ? HUGE_PAGE_SIZE : BUSTUB_PAGE_SIZE;
+  const size_t begin = RoundUp(static_cast<size_t>(first_frame_id) * BUSTUB_PAGE_SIZE, granularity);
+  const size_t end = (static_cast<size_t>(first_frame_id) + num_frames) * BUSTUB_PAGE_SIZE / granularity * granularity;
+  if (begin < end) {
+    madvise(data_ + begin, end - begin, MADV_DONTNEED);
+  }
+}
+
+FrameMemory::~FrameMemory() { munmap(data_, size_); }
+
+}  // namespace bustub
@@ -14,36 +14,112 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-    lst = new my_list(num_frames,k);
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k), nodes_(num_frames) {
+  BUSTUB_ASSERT(k > 0, "k must be at least 1");
 }
 
-LRUKReplacer::~LRUKReplacer(){
-    delete lst;
+auto LRUKReplacer::EvictionSetOf(const LRUKNode &node) -> std::set<EvictionKey> & {
+  if (node.scan_only_) {
+    return scan_frames_;
+  }
+  return node.history_.size() < k_ ? inf_frames_ : kth_frames_;
 }
+
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-    std::scoped_lock sl(latch_);
-    return lst->evcit(frame_id);
+  std::scoped_lock lock(latch_);
+  for (auto *frames : {&scan_frames_, &inf_frames_, &kth_frames_}) {
+    if (frames->empty()) {
+      continue;
+    }
+    *frame_id = frames->begin()->second;
+    frames->erase(frames->begin());
+    nodes_[*frame_id] = LRUKNode();
+    curr_size_--;
+    return true;
+  }
+  return false;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
-   std::scoped_lock sl(latch_);
-   lst->add(frame_id);
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  const bool tracked = !node.history_.empty();
+  if (access_type == AccessType::Scan) {
+    if (!tracked) {
+      node.history_.push_back(current_timestamp_++);
+      node.scan_only_ = true;
+    }
+    return;
+  }
+
+  // The frame moves to another set or to another position in its set, take it out first.
+  if (node.is_evictable_) {
+    EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  }
+  node.scan_only_ = false;
+  node.history_.push_back(current_timestamp_++);
+  if (node.history_.size() > k_) {
+    node.history_.pop_front();
+  }
+  if (node.is_evictable_) {
+    EvictionSetOf(node).insert(EvictionKeyOf(frame_id));
+  }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
-    std::scoped_lock sl(latch_);
-    lst->set(frame_id,set_evictable);
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (node.history_.empty() || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictionSetOf(node).insert(EvictionKeyOf(frame_id));
+    curr_size_++;
+  } else {
+    EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+    curr_size_--;
+  }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
-    std::scoped_lock sl(latch_);
-    lst->remove(frame_id);
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (node.history_.empty()) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a non-evictable frame");
+  EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  node = LRUKNode();
+  curr_size_--;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto *frames : {&scan_frames_, &inf_frames_, &kth_frames_}) {
+    for (auto it = frames->begin(); it != frames->end() && candidates.size() < max_candidates; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
 }
 
-auto LRUKReplacer::Size() -> size_t { 
-    std::scoped_lock sl(latch_);
-    return lst->get_cur();
+void LRUKReplacer::Resize(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  for (size_t i = num_frames; i < nodes_.size(); i++) {
+    BUSTUB_ASSERT(nodes_[i].history_.empty(), "cannot drop a tracked frame");
+  }
+  nodes_.resize(num_frames);
+  replacer_size_ = num_frames;
 }
 
 }  // namespace bustub
@@ -14,16 +14,92 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : num_pages_(num_pages), nodes_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  nodes_[*frame_id] = LRUNode();
+  return true;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (access_type == AccessType::Scan) {
+    if (!node.tracked_) {
+      node.tracked_ = true;
+      node.scan_only_ = true;
+      node.last_access_ = current_timestamp_++;
+    }
+    return;
+  }
+  if (node.is_evictable_) {
+    evictable_.erase(EvictionKeyOf(frame_id));
+  }
+  node.tracked_ = true;
+  node.scan_only_ = false;
+  node.last_access_ = current_timestamp_++;
+  if (node.is_evictable_) {
+    evictable_.insert(EvictionKeyOf(frame_id));
+  }
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_ || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    evictable_.insert(EvictionKeyOf(frame_id));
+  } else {
+    evictable_.erase(EvictionKeyOf(frame_id));
+  }
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a non-evictable frame");
+  evictable_.erase(EvictionKeyOf(frame_id));
+  node = LRUNode();
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return evictable_.size();
+}
+
+auto LRUReplacer::EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = evictable_.begin(); it != evictable_.end() && candidates.size() < max_candidates; ++it) {
+    candidates.push_back(std::get<2>(*it));
+  }
+  return candidates;
+}
+
+void LRUReplacer::Resize(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  for (size_t i = num_frames; i < nodes_.size(); i++) {
+    BUSTUB_ASSERT(!nodes_[i].tracked_, "cannot drop a tracked frame");
+  }
+  nodes_.resize(num_frames);
+  num_pages_ = num_frames;
+}
 
 }  // namespace bustub
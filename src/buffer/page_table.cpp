@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <utility>
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  tables_.push_back(std::make_unique<Slots>(max_entries));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+PageTable::Slots::Slots(size_t max_entries) {
+  size_t num_slots = 2;
+  int log_slots = 1;
+  while (num_slots < 2 * max_entries) {
+    num_slots *= 2;
+    log_slots++;
+  }
+  mask_ = num_slots - 1;
+  shift_ = 64 - log_slots;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Slots::SlotOf(page_id_t page_id) const -> size_t {
+  size_t i = HomeOf(page_id);
+  while (true) {
+    const uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || PageOf(slot) == page_id) {
+      return i;
+    }
+    i = (i + 1) & mask_;
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "invalid page id");
+  std::scoped_lock lock(write_latch_);
+  Slots *table = tables_.back().get();
+  const size_t i = table->SlotOf(page_id);
+  if (table->slots_[i].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+    BUSTUB_ASSERT(2 * (Size() + 1) <= table->mask_ + 1, "page table is full");
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+  table->slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  std::scoped_lock lock(write_latch_);
+  Slots *table = tables_.back().get();
+  size_t hole = table->SlotOf(page_id);
+  if (table->slots_[hole].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+    return false;
+  }
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // Backward-shift deletion: move every entry of the cluster after the hole back into it, unless the entry's home slot
+  // lies between the hole and the entry, in which case moving it would put it before its home.
+  for (size_t i = (hole + 1) & table->mask_;; i = (i + 1) & table->mask_) {
+    const uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    const size_t home = table->HomeOf(PageOf(slot));
+    const bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      table->slots_[hole].store(slot, std::memory_order_relaxed);
+      hole = i;
+    }
+  }
+  table->slots_[hole].store(EMPTY_SLOT, std::memory_order_relaxed);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+
+  version_.store(version + 2, std::memory_order_release);
+  return true;
+}
+
+void PageTable::Reserve(size_t max_entries) {
+  std::scoped_lock lock(write_latch_);
+  const Slots *old_table = tables_.back().get();
+  if (2 * max_entries <= old_table->mask_ + 1) {
+    return;
+  }
+  auto table = std::make_unique<Slots>(max_entries);
+  for (size_t i = 0; i <= old_table->mask_; i++) {
+    const uint64_t slot = old_table->slots_[i].load(std::memory_order_relaxed);
+    if (slot != EMPTY_SLOT) {
+      table->slots_[table->SlotOf(PageOf(slot))].store(slot, std::memory_order_relaxed);
+    }
+  }
+  // A Find that started on the old slots notices the version change and probes again, in the new slots.
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  table_.store(table.get(), std::memory_order_release);
+  tables_.push_back(std::move(table));
+  version_.store(version + 2, std::memory_order_release);
+}
+
+}  // namespace bustub
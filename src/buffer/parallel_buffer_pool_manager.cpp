@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     ReplacementPolicy replacement_policy, size_t max_pool_size,
+                                                     size_t compressed_cache_size)
+    : pool_size_(num_instances * pool_size), disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, replacement_policy, max_pool_size, compressed_cache_size));
+  }
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t { return pool_size_; }
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "cannot route an invalid page id");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(double clean_ratio, std::chrono::milliseconds interval) {
+  for (auto &instance : instances_) {
+    instance->StartPageCleaner(clean_ratio, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto &instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+auto ParallelBufferPoolManager::GetBackgroundWritebacks() const -> uint64_t {
+  uint64_t writebacks = 0;
+  for (const auto &instance : instances_) {
+    writebacks += instance->GetBackgroundWritebacks();
+  }
+  return writebacks;
+}
+
+auto ParallelBufferPoolManager::GetForegroundWritebacks() const -> uint64_t {
+  uint64_t writebacks = 0;
+  for (const auto &instance : instances_) {
+    writebacks += instance->GetForegroundWritebacks();
+  }
+  return writebacks;
+}
+
+auto ParallelBufferPoolManager::DumpResidentPages(const std::string &file_name) -> bool {
+  bool dumped = true;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    dumped = instances_[i]->DumpResidentPages(InstanceFileName(file_name, i)) && dumped;
+  }
+  return dumped;
+}
+
+void ParallelBufferPoolManager::StartPageDumper(const std::string &file_name, std::chrono::milliseconds interval) {
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instances_[i]->StartPageDumper(InstanceFileName(file_name, i), interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageDumper() {
+  for (auto &instance : instances_) {
+    instance->StopPageDumper();
+  }
+}
+
+auto ParallelBufferPoolManager::StartWarmup(const std::string &file_name) -> size_t {
+  size_t num_pages = 0;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    num_pages += instances_[i]->StartWarmup(InstanceFileName(file_name, i));
+  }
+  return num_pages;
+}
+
+void ParallelBufferPoolManager::WaitForWarmup() {
+  for (auto &instance : instances_) {
+    instance->WaitForWarmup();
+  }
+}
+
+void ParallelBufferPoolManager::StopWarmup() {
+  for (auto &instance : instances_) {
+    instance->StopWarmup();
+  }
+}
+
+auto ParallelBufferPoolManager::GetNumWarmedPages() const -> uint64_t {
+  uint64_t pages = 0;
+  for (const auto &instance : instances_) {
+    pages += instance->GetNumWarmedPages();
+  }
+  return pages;
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  // Each caller gets its own starting point, so concurrent NewPage calls fan out over the shards instead of all
+  // piling up on the same instance.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * {
+  if (near_page_id == INVALID_PAGE_ID) {
+    return NewPgImp(page_id);
+  }
+  const size_t num_instances = instances_.size();
+  const size_t start = static_cast<size_t>(near_page_id + 1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *page = instances_[(start + i) % num_instances]->NewPageNear(page_id, near_page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewSegmentImp() -> segment_id_t { return disk_manager_->CreateSegment(); }
+
+auto ParallelBufferPoolManager::DeleteSegmentImp(segment_id_t segment) -> bool {
+  if (segment == DEFAULT_SEGMENT_ID || !disk_manager_->HasSegment(segment)) {
+    return false;
+  }
+  for (auto &instance : instances_) {
+    if (!instance->DiscardSegment(segment)) {
+      return false;
+    }
+  }
+  return disk_manager_->DeleteSegment(segment);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  std::vector<std::vector<frame_id_t>> frame_ids;
+  frame_ids.reserve(instances_.size());
+  for (auto &instance : instances_) {
+    frame_ids.push_back(instance->BeginFlushAll(&batch));
+  }
+  disk_manager_->WritePages(std::move(batch));
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instances_[i]->EndFlushAll(frame_ids[i]);
+  }
+  disk_manager_->SyncPages();
+}
+
+void ParallelBufferPoolManager::PrefetchPgsImp(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i]);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::ResizeImp(size_t pool_size) -> bool {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    return false;
+  }
+  // Every instance has the same maximum, so checking the largest share is enough.
+  if ((pool_size + num_instances - 1) / num_instances > instances_[0]->GetMaxPoolSize()) {
+    return false;
+  }
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0));
+  }
+  pool_size_ = pool_size;
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : num_frames_(num_frames),
+      kin_(std::max<size_t>(1, num_frames / 4)),
+      kout_(std::max<size_t>(1, num_frames / 2)),
+      nodes_(num_frames) {}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (a1in_.empty() && am_.empty()) {
+    return false;
+  }
+  auto &frames = EvictFromA1in() ? a1in_ : am_;
+  *frame_id = frames.begin()->second;
+  frames.erase(frames.begin());
+
+  auto &node = nodes_[*frame_id];
+  if (node.queue_ == Queue::A1IN) {
+    a1in_size_--;
+    if (!node.scan_only_ && node.page_id_ != INVALID_PAGE_ID) {
+      a1out_.PushBack(node.page_id_);
+      if (a1out_.Size() > kout_) {
+        a1out_.PopFront();
+      }
+    }
+  }
+  node = TwoQNode();
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  const bool scan = access_type == AccessType::Scan;
+  if (!node.tracked_) {
+    node.tracked_ = true;
+    node.timestamp_ = current_timestamp_++;
+    if (!scan && node.page_id_ != INVALID_PAGE_ID && a1out_.Erase(node.page_id_)) {
+      node.queue_ = Queue::AM;
+    } else {
+      node.queue_ = Queue::A1IN;
+      node.scan_only_ = scan;
+      a1in_size_++;
+    }
+    return;
+  }
+  if (scan) {
+    return;
+  }
+  node.scan_only_ = false;
+  // Accesses in A1in are correlated with the first one, they do not change its position.
+  if (node.queue_ == Queue::AM) {
+    if (node.is_evictable_) {
+      am_.erase(EvictionKeyOf(frame_id));
+    }
+    node.timestamp_ = current_timestamp_++;
+    if (node.is_evictable_) {
+      am_.insert(EvictionKeyOf(frame_id));
+    }
+  }
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_ || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictionSetOf(node).insert(EvictionKeyOf(frame_id));
+  } else {
+    EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  auto &node = nodes_[frame_id];
+  if (!node.tracked_) {
+    return;
+  }
+  BUSTUB_ASSERT(node.is_evictable_, "cannot remove a non-evictable frame");
+  EvictionSetOf(node).erase(EvictionKeyOf(frame_id));
+  if (node.queue_ == Queue::A1IN) {
+    a1in_size_--;
+  }
+  node = TwoQNode();
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::scoped_lock lock(latch_);
+  return a1in_.size() + am_.size();
+}
+
+auto TwoQReplacer::EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> {
+  std::scoped_lock lock(latch_);
+  // Which queue goes first changes as frames are evicted; this uses the queue the next victim comes from.
+  std::vector<frame_id_t> candidates;
+  const bool a1in_first = EvictFromA1in();
+  for (auto *frames : {a1in_first ? &a1in_ : &am_, a1in_first ? &am_ : &a1in_}) {
+    for (auto it = frames->begin(); it != frames->end() && candidates.size() < max_candidates; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+void TwoQReplacer::Resize(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  for (size_t i = num_frames; i < nodes_.size(); i++) {
+    BUSTUB_ASSERT(!nodes_[i].tracked_, "cannot drop a tracked frame");
+  }
+  nodes_.resize(num_frames);
+  num_frames_ = num_frames;
+  // The queue sizes are fractions of the pool, as in the constructor.
+  kin_ = std::max<size_t>(1, num_frames / 4);
+  kout_ = std::max<size_t>(1, num_frames / 2);
+  while (a1out_.Size() > kout_) {
+    a1out_.PopFront();
+  }
+}
+
+void TwoQReplacer::SetFramePage(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_, "invalid frame id");
+  nodes_[frame_id].page_id_ = page_id;
+}
+
+}  // namespace bustub
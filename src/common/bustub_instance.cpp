@@ -7,6 +7,7 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/enums/statement_type.h"
@@ -32,21 +33,47 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, transaction_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t buffer_pool_instances, bool warm_restart) {
   // TODO(chi): revisit this when designing the recovery project.
 
   enable_logging = false;
 
-  // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  // Storage related. Pages carry checksums, so a corrupt or torn page is reported when it is read.
+  disk_manager_ = new DiskManager(db_file_name, false, true);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, we use BUSTUB_INSTANCE_POOL_SIZE instead of the
+  // default buffer pool size. When sharded, the frames are split evenly over the instances. The pool can be resized
+  // later with `\resize`, up to BUSTUB_INSTANCE_MAX_POOL_SIZE frames.
+  //
+  // With warm restarts, the resident pages are dumped next to the db file every buffer_pool_dump_interval and at
+  // shutdown, and the next start warms the pool up from the dump in the background.
+  const std::string::size_type n = db_file_name.rfind('.');
+  const std::string dump_file_name = db_file_name.substr(0, n) + ".bpdump";
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (buffer_pool_instances > 1) {
+      auto frames_per_instance = (BUSTUB_INSTANCE_POOL_SIZE + buffer_pool_instances - 1) / buffer_pool_instances;
+      auto max_frames_per_instance =
+          (BUSTUB_INSTANCE_MAX_POOL_SIZE + buffer_pool_instances - 1) / buffer_pool_instances;
+      auto *parallel_bpm =
+          new ParallelBufferPoolManager(buffer_pool_instances, frames_per_instance, disk_manager_, LRUK_REPLACER_K,
+                                        log_manager_, ReplacementPolicy::LRU_K, max_frames_per_instance);
+      if (warm_restart) {
+        parallel_bpm->StartWarmup(dump_file_name);
+        parallel_bpm->StartPageDumper(dump_file_name);
+      }
+      buffer_pool_manager_ = parallel_bpm;
+    } else {
+      auto *bpm = new BufferPoolManagerInstance(BUSTUB_INSTANCE_POOL_SIZE, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                ReplacementPolicy::LRU_K, BUSTUB_INSTANCE_MAX_POOL_SIZE);
+      if (warm_restart) {
+        bpm->StartWarmup(dump_file_name);
+        bpm->StartPageDumper(dump_file_name);
+      }
+      buffer_pool_manager_ = bpm;
+    }
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -99,11 +126,40 @@ auto BustubInstance::ExecuteSql(const std::string &sql) -> std::vector<std::stri
       }
       return info;
     }
+    if (StringUtil::StartsWith(internal_sql, "\\resize")) {
+      if (buffer_pool_manager_ == nullptr) {
+        return {"buffer pool is not available"};
+      }
+      auto arg = StringUtil::Strip(std::string(internal_sql.cbegin() + 7, internal_sql.cend()), ' ');
+      if (!arg.empty()) {
+        size_t pool_size = 0;
+        try {
+          pool_size = std::stoul(arg);
+        } catch (std::exception &e) {
+          return {fmt::format("invalid buffer pool size: {}", arg)};
+        }
+        if (!buffer_pool_manager_->Resize(pool_size)) {
+          return {fmt::format("can't resize the buffer pool to {} frames", pool_size)};
+        }
+      }
+      return {fmt::format("buffer pool size: {} frames", buffer_pool_manager_->GetPoolSize())};
+    }
+    if (StringUtil::StartsWith(internal_sql, "\\synchronous_commit")) {
+      auto arg = StringUtil::Strip(std::string(internal_sql.cbegin() + 19, internal_sql.cend()), ' ');
+      if (arg == "on" || arg == "off") {
+        synchronous_commit_ = arg == "on";
+      } else if (!arg.empty()) {
+        return {fmt::format("invalid synchronous_commit value: {}", arg)};
+      }
+      return {fmt::format("synchronous_commit: {}", synchronous_commit_ ? "on" : "off")};
+    }
     if (sql == "\\help") {
       return {"Welcome to the BusTub shell!\n",
               "",
               "\\dt: show all tables",
               "\\d <table>: show info about a table",
+              "\\resize [frames]: show or change the number of frames of the buffer pool",
+              "\\synchronous_commit [on|off]: show or change whether commits wait for the log to be on disk",
               "\\help: show this message again",
               "",
               "BusTub shell currently only supports a small set of Postgres queries.",
@@ -127,7 +183,7 @@ auto BustubInstance::ExecuteSql(const std::string &sql) -> std::vector<std::stri
     switch (statement->type_) {
       case StatementType::CREATE_STATEMENT: {
         const auto &create_stmt = dynamic_cast<const CreateStatement &>(*statement);
-        auto txn = transaction_manager_->Begin();
+        auto txn = transaction_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, synchronous_commit_);
         auto info = catalog_->CreateTable(txn, create_stmt.table_, Schema(create_stmt.columns_));
         transaction_manager_->Commit(txn);
         delete txn;
@@ -139,7 +195,7 @@ auto BustubInstance::ExecuteSql(const std::string &sql) -> std::vector<std::stri
       }
       case StatementType::INDEX_STATEMENT: {
         const auto &index_stmt = dynamic_cast<const IndexStatement &>(*statement);
-        auto txn = transaction_manager_->Begin();
+        auto txn = transaction_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, synchronous_commit_);
 
         std::vector<uint32_t> col_ids;
         for (const auto &col : index_stmt.cols_) {
@@ -207,7 +263,7 @@ auto BustubInstance::ExecuteSql(const std::string &sql) -> std::vector<std::stri
     auto optimized_plan = optimizer.Optimize(planner.plan_);
 
     // Execute the query.
-    auto txn = transaction_manager_->Begin();
+    auto txn = transaction_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ, synchronous_commit_);
     auto exec_ctx = MakeExecutorContext(txn);
     std::vector<Tuple> result_set{};
     execution_engine_->Execute(optimized_plan, &result_set, txn, exec_ctx.get());
@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The Castagnoli polynomial, bit-reflected. */
+constexpr uint32_t POLY = 0x82f63b78;
+
+auto Load64(const uint8_t *p) -> uint64_t {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/** Tables of the software CRC: table k holds the CRC of a byte followed by k zero bytes. */
+struct Tables {
+  std::array<std::array<uint32_t, 256>, 8> table_;
+
+  Tables() {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t crc = n;
+      for (int k = 0; k < 8; k++) {
+        crc = (crc & 1) != 0 ? (crc >> 1) ^ POLY : crc >> 1;
+      }
+      table_[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+      for (size_t k = 1; k < 8; k++) {
+        table_[k][n] = (table_[k - 1][n] >> 8) ^ table_[0][table_[k - 1][n] & 0xff];
+      }
+    }
+  }
+};
+
+auto GetTables() -> const Tables & {
+  static const Tables tables;
+  return tables;
+}
+
+/** Slicing-by-8: eight bytes per step, one lookup per byte. Works on the inverted crc. */
+auto ExtendWithTables(uint32_t crc, const uint8_t *next, size_t size) -> uint32_t {
+  const auto &t = GetTables().table_;
+  while (size >= 8) {
+    // Little-endian: the first byte of the word is the lowest one.
+    const uint64_t word = Load64(next) ^ crc;
+    crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+          t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+    next += 8;
+    size -= 8;
+  }
+  while (size-- > 0) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *next++) & 0xff];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+/** Bytes each of the three streams of the hardware CRC covers per step. */
+constexpr size_t STREAM_SIZE = 256;
+
+/**
+ * Tables that shift a crc over STREAM_SIZE zero bytes, one per byte of the crc, to merge the crcs of the streams:
+ * crc(a + b) = shift(crc(a)) ^ crc(b) for a b of STREAM_SIZE bytes, with crc(b) started from zero.
+ */
+struct ShiftTables {
+  std::array<std::array<uint32_t, 256>, 4> table_;
+
+  /** @return the product of a 32x32 matrix over GF(2), one column per word, and a vector */
+  static auto Times(const uint32_t *matrix, uint32_t vector) -> uint32_t {
+    uint32_t sum = 0;
+    for (; vector != 0; vector >>= 1, matrix++) {
+      if ((vector & 1) != 0) {
+        sum ^= *matrix;
+      }
+    }
+    return sum;
+  }
+
+  static void Square(uint32_t *square, const uint32_t *matrix) {
+    for (int n = 0; n < 32; n++) {
+      square[n] = Times(matrix, matrix[n]);
+    }
+  }
+
+  ShiftTables() {
+    // The operator that feeds one zero bit into the crc, squared until it feeds STREAM_SIZE zero bytes.
+    std::array<uint32_t, 32> op;
+    std::array<uint32_t, 32> tmp;
+    op[0] = POLY;
+    for (int n = 1; n < 32; n++) {
+      op[n] = 1U << (n - 1);
+    }
+    for (size_t bits = 1; bits < STREAM_SIZE * 8; bits *= 2) {
+      Square(tmp.data(), op.data());
+      op = tmp;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+      for (int k = 0; k < 4; k++) {
+        table_[k][n] = Times(op.data(), n << (8 * k));
+      }
+    }
+  }
+
+  auto Shift(uint32_t crc) const -> uint32_t {
+    return table_[0][crc & 0xff] ^ table_[1][(crc >> 8) & 0xff] ^ table_[2][(crc >> 16) & 0xff] ^
+           table_[3][crc >> 24];
+  }
+};
+
+auto GetShiftTables() -> const ShiftTables & {
+  static const ShiftTables tables;
+  return tables;
+}
+
+/**
+ * The crc32 instruction has a latency of three cycles but issues one per cycle, so three independent streams keep it
+ * busy. Works on the inverted crc.
+ */
+__attribute__((target("sse4.2"))) auto ExtendWithHardware(uint32_t crc, const uint8_t *next, size_t size)
+    -> uint32_t {
+  const auto &shift = GetShiftTables();
+  uint64_t crc0 = crc;
+  while (size >= 3 * STREAM_SIZE) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < STREAM_SIZE; i += 8) {
+      crc0 = _mm_crc32_u64(crc0, Load64(next + i));
+      crc1 = _mm_crc32_u64(crc1, Load64(next + STREAM_SIZE + i));
+      crc2 = _mm_crc32_u64(crc2, Load64(next + 2 * STREAM_SIZE + i));
+    }
+    crc0 = shift.Shift(static_cast<uint32_t>(crc0)) ^ crc1;
+    crc0 = shift.Shift(static_cast<uint32_t>(crc0)) ^ crc2;
+    next += 3 * STREAM_SIZE;
+    size -= 3 * STREAM_SIZE;
+  }
+  for (; size >= 8; next += 8, size -= 8) {
+    crc0 = _mm_crc32_u64(crc0, Load64(next));
+  }
+  auto crc32 = static_cast<uint32_t>(crc0);
+  while (size-- > 0) {
+    crc32 = _mm_crc32_u8(crc32, *next++);
+  }
+  return crc32;
+}
+
+#endif
+
+}  // namespace
+
+auto Crc32c::Extend(uint32_t crc, const char *data, size_t size) -> uint32_t {
+  const auto *next = reinterpret_cast<const uint8_t *>(data);
+#if defined(__x86_64__)
+  if (IsHardwareAccelerated()) {
+    return ~ExtendWithHardware(~crc, next, size);
+  }
+#endif
+  return ~ExtendWithTables(~crc, next, size);
+}
+
+auto Crc32c::ComputeWithTables(const char *data, size_t size) -> uint32_t {
+  return ~ExtendWithTables(~0U, reinterpret_cast<const uint8_t *>(data), size);
+}
+
+auto Crc32c::IsHardwareAccelerated() -> bool {
+#if defined(__x86_64__)
+  static const bool has_sse42 = __builtin_cpu_supports("sse4.2") != 0;
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+
+}  // namespace bustub
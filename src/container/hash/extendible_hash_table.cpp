@@ -83,56 +83,47 @@ auto ExtendibleHashTable<K, V>::Remove(const K& key) -> bool {
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K& key, const V& value) {
     std::scoped_lock<std::mutex> lock(latch_);
-    size_t index = IndexOf(key);
-    auto ptr = dir_[index];
-    bool rs = ptr->Insert(key, value);
-    if (rs) {//success
-      //global_depth_ = max(dir_[index]->GetDepth , global_depth_);
-        return;
-    }
-    else {//fail
-        if (ptr->GetDepth() == global_depth_) {//L==G
-        //std::cout<<"L==G\n";
-            global_depth_++;
-            ptr->IncrementDepth();
-            //split
+    // A split may leave every item on the same side again (e.g. keys that share their low bits), so keep splitting
+    // the target bucket until the key fits.
+    while (true) {
+        auto bucket = dir_[IndexOf(key)];
+        if (bucket->Insert(key, value)) {
+            return;
+        }
+        if (bucket->GetDepth() == global_depth_) {
+            // L == G: double the directory, the new half mirrors the old one.
             size_t cap = dir_.size();
             dir_.resize(cap * 2);
-            num_buckets_*=2;
             for (size_t i = 0; i < cap; i++) {
                 dir_[i + cap] = dir_[i];
             }
-            //redistribute
-            std::shared_ptr<Bucket> new_bucket = std::make_shared<Bucket>(bucket_size_, ptr->GetDepth());
-            dir_[index + cap] = new_bucket;
-            for (size_t i = 0; i < bucket_size_; i++) {
-                auto kv = ptr->GetItems().front();
-                ptr->GetItems().pop_front();
-                size_t idx = IndexOf(kv.first);
-                dir_[idx]->GetItems().push_back(kv);
-            }
-
+            global_depth_++;
         }
-        else {//L<G
-        //std::cout<<"L<G\n";
-            ptr->IncrementDepth();
-            size_t cap = dir_.size() / 2;
-            //redistribute
-            std::shared_ptr<Bucket> new_bucket = std::make_shared<Bucket>(bucket_size_, ptr->GetDepth());
-            
-            dir_[(index + cap)%dir_.size()] = new_bucket;
-            for (size_t i = 0; i < bucket_size_; i++) {
-                auto kv = ptr->GetItems().front();
-                ptr->GetItems().pop_front();
-                size_t idx = IndexOf(kv.first);
-                dir_[idx]->GetItems().push_back(kv);
-            }
+        RedistributeBucket(bucket);
+    }
+}
 
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void {
+    // Items whose hash has the bit just above the old local depth set move to the new sibling bucket, and so do the
+    // directory slots that point to the old bucket and have that bit set.
+    size_t split_bit = static_cast<size_t>(1) << bucket->GetDepth();
+    bucket->IncrementDepth();
+    auto sibling = std::make_shared<Bucket>(bucket_size_, bucket->GetDepth());
+    num_buckets_++;
+    for (size_t i = 0; i < dir_.size(); i++) {
+        if (dir_[i] == bucket && (i & split_bit) != 0) {
+            dir_[i] = sibling;
+        }
+    }
+    auto &items = bucket->GetItems();
+    for (auto it = items.begin(); it != items.end();) {
+        if ((std::hash<K>()(it->first) & split_bit) != 0) {
+            sibling->GetItems().push_back(*it);
+            it = items.erase(it);
+        } else {
+            ++it;
         }
-        //add kv
-        index = IndexOf(key);
-        ptr = dir_[index];
-        ptr->Insert(key, value);
     }
 }
 
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident pages live in T1 if they were accessed once since they were loaded and in T2 if they were accessed again;
+ * both are LRU lists. B1 and B2 remember the ids of the pages recently evicted from T1 and T2. A page that is loaded
+ * while it is in B1 means T1 was too small, so the target size p of T1 grows; a page loaded while it is in B2 makes
+ * p shrink. Either way the page goes straight to T2. Frames are evicted from T1 while it is larger than p, from T2
+ * otherwise.
+ *
+ * Unlike the textbook version, eviction is decoupled from loading and skips pinned frames, so the list sizes are only
+ * kept within the bounds of the paper (|T1| + |B1| <= c, |T1| + |T2| + |B1| + |B2| <= 2c) by trimming the ghost
+ * lists. Scan accesses never promote a frame to T2, frames that were only scanned are evicted first from T1 and leave
+ * no trace in B1.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+  using Replacer::RecordAccess;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
+  void SetFramePage(frame_id_t frame_id, page_id_t page_id) override;
+
+  /** @return the current target size of T1 */
+  auto GetTarget() -> size_t {
+    std::scoped_lock lock(latch_);
+    return p_;
+  }
+
+ private:
+  enum class List { T1, T2 };
+
+  struct ARCNode {
+    bool tracked_{false};
+    bool is_evictable_{false};
+    List list_{List::T1};
+    /** True if the frame was only scanned. */
+    bool scan_only_{false};
+    size_t last_access_{0};
+    /** The page in the frame, as told by SetFramePage. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** (not scan only, last access, frame id): scan-only frames sort first. */
+  using EvictionKey = std::tuple<bool, size_t, frame_id_t>;
+
+  auto EvictionSetOf(const ARCNode &node) -> std::set<EvictionKey> & { return node.list_ == List::T1 ? t1_ : t2_; }
+
+  auto EvictionKeyOf(frame_id_t frame_id) const -> EvictionKey {
+    return {!nodes_[frame_id].scan_only_, nodes_[frame_id].last_access_, frame_id};
+  }
+
+  /** @return true if the next victim comes from T1 */
+  auto EvictFromT1() const -> bool { return !t1_.empty() && (t2_.empty() || t1_size_ > p_); }
+
+  /** Drop the oldest ghosts until the lists are within the bounds of the paper again. */
+  void TrimGhosts();
+
+  size_t current_timestamp_{0};
+  /** The number of frames, c in the paper. */
+  size_t num_frames_;
+  /** Target size of T1. */
+  size_t p_{0};
+  /** Number of frames in T1 and T2, evictable or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Per-frame state, indexed by frame id. */
+  std::vector<ARCNode> nodes_;
+  /** Evictable frames in T1 and T2, the next victim first. */
+  std::set<EvictionKey> t1_;
+  std::set<EvictionKey> t2_;
+  /** Pages recently evicted from T1 and T2. */
+  GhostList b1_;
+  GhostList b2_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
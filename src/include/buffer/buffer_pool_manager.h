@@ -15,6 +15,7 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
@@ -45,6 +46,14 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page and tell the buffer pool why it is being accessed, see AccessType.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type) -> Page * { return FetchPgImp(page_id, access_type); }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -84,6 +93,49 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Create a new page like NewPage, placed on disk right after near_page_id if that page id is free, and otherwise
+   * in the lowest free page id. Callers that grow a structure page by page, e.g. a table heap, pass their last page
+   * so that the structure stays contiguous on disk and scans of it stay sequential.
+   * @param[out] page_id id of created page
+   * @param near_page_id the page the new page should follow on disk
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageNear(page_id_t *page_id, page_id_t near_page_id) -> Page * { return NewPgImp(page_id, near_page_id); }
+
+  /**
+   * Create a new segment for a table or an index, see DiskManager::CreateSegment. The pages of the segment are
+   * created with NewPageNear, the first one near DiskManager::SegmentHeaderPageId of the segment.
+   * @return the id of the new segment, DEFAULT_SEGMENT_ID if all pages live in the db file
+   */
+  auto NewSegment() -> segment_id_t { return NewSegmentImp(); }
+
+  /**
+   * Delete a segment with all of its pages, e.g. because its table is dropped. The pages are dropped from the buffer
+   * pool without being written back, and the file of the segment is deleted as a whole. No page of the segment may be
+   * fetched while it is deleted.
+   * @param segment id of the segment
+   * @return false if a page of the segment is pinned, or there is no such segment
+   */
+  auto DeleteSegment(segment_id_t segment) -> bool { return DeleteSegmentImp(segment); }
+
+  /**
+   * Hint that the given pages will be fetched soon. Reads of pages that are not in the buffer pool are started in the
+   * background; the pages are not pinned, so the caller still has to FetchPage them. Pages that cannot be prefetched
+   * right now are skipped.
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) { PrefetchPgsImp(page_ids); }
+
+  /**
+   * Grow or shrink the buffer pool while it is in use. Shrinking evicts the pages in the frames that go away: clean
+   * pages right away, dirty pages once they are written back, and pinned pages once they are unpinned, so it blocks
+   * until every page in those frames is unpinned.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool cannot take that size
+   */
+  auto Resize(size_t pool_size) -> bool { return ResizeImp(pool_size); }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -108,6 +160,15 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool for the given type of access. The default implementation ignores
+   * the access type.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * { return FetchPgImp(page_id); }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +191,15 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Creates a new page in the buffer pool, preferably right after near_page_id on disk. The default implementation
+   * ignores the hint.
+   * @param[out] page_id id of created page
+   * @param near_page_id the page the new page should follow on disk
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -141,5 +211,31 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Start background reads of the given pages. The default implementation ignores the hint.
+   * @param page_ids ids of the pages to read ahead
+   */
+  virtual void PrefetchPgsImp(const std::vector<page_id_t> &page_ids) {}
+
+  /**
+   * Create a new segment. The default implementation keeps all pages in the db file.
+   * @return the id of the new segment
+   */
+  virtual auto NewSegmentImp() -> segment_id_t { return DEFAULT_SEGMENT_ID; }
+
+  /**
+   * Delete a segment with all of its pages. The default implementation has no segments to delete.
+   * @param segment id of the segment
+   * @return false if the segment could not be deleted
+   */
+  virtual auto DeleteSegmentImp(segment_id_t segment) -> bool { return false; }
+
+  /**
+   * Change the number of frames. The default implementation cannot resize.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool cannot take that size
+   */
+  virtual auto ResizeImp(size_t pool_size) -> bool { return false; }
 };
 }  // namespace bustub
@@ -12,14 +12,25 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_memory.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -37,9 +48,32 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacement_policy the policy that picks the frames to evict
+   * @param max_pool_size the size the pool may grow to with Resize, 0 for pool_size
+   * @param compressed_cache_size bytes of the compressed page cache behind the pool, 0 for none
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr,
+                            ReplacementPolicy replacement_policy = ReplacementPolicy::LRU_K, size_t max_pool_size = 0,
+                            size_t compressed_cache_size = 0);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacement_policy the policy that picks the frames to evict
+   * @param max_pool_size the size the pool may grow to with Resize, 0 for pool_size
+   * @param compressed_cache_size bytes of the compressed page cache behind the pool, 0 for none
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr,
+                            ReplacementPolicy replacement_policy = ReplacementPolicy::LRU_K, size_t max_pool_size = 0,
+                            size_t compressed_cache_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,9 +83,127 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
+  /** @brief Return the size the buffer pool may grow to. */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /**
+   * @brief Return the pointer to all the pages in the buffer pool. There are GetMaxPoolSize() of them; the ones past
+   * GetPoolSize() never hold a page once a shrinking Resize has returned.
+   */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the memory that holds the page data of the frames. */
+  auto GetFrameMemory() const -> const FrameMemory & { return *frame_memory_; }
+
+  /**
+   * @brief Return the compressed page cache behind the pool, nullptr if there is none. Every page the pool drops is
+   * put into the cache, once it is written back if it is dirty, and a miss looks there before reading from disk.
+   */
+  auto GetCompressedCache() -> CompressedPageCache * { return compressed_cache_.get(); }
+
+  /**
+   * @brief Start the page cleaner, a background thread that writes back dirty pages before they are chosen as
+   * victims, so that misses do not have to write back a page before they can read theirs.
+   *
+   * Every round the cleaner walks the evictable frames in the replacer's eviction order and writes back dirty ones
+   * until at least clean_ratio of the evictable and free frames are clean. With logging enabled, a page is only
+   * written once its LSN is persistent in the log. Does nothing if the cleaner is already running.
+   *
+   * @param clean_ratio share of the evictable and free frames that should be clean, between 0 and 1
+   * @param interval time between two rounds when no miss wakes the cleaner up earlier
+   */
+  void StartPageCleaner(double clean_ratio = PAGE_CLEANER_CLEAN_RATIO,
+                        std::chrono::milliseconds interval = page_cleaner_interval);
+
+  /** @brief Stop and join the page cleaner. Does nothing if the cleaner is not running. */
+  void StopPageCleaner();
+
+  /** @brief Return the number of dirty pages the page cleaner wrote back. */
+  auto GetBackgroundWritebacks() const -> uint64_t { return background_writebacks_; }
+
+  /** @brief Return the number of dirty victims that NewPage or FetchPage still had to write back themselves. */
+  auto GetForegroundWritebacks() const -> uint64_t { return foreground_writebacks_; }
+
+  /** @brief Return the number of pages read by the prefetch thread. */
+  auto GetNumPrefetches() const -> uint64_t { return prefetches_; }
+
+  /**
+   * @brief Write the ids of the resident pages to a file, one per line, ranked by the replacer: first the pages that
+   * are in use, then the evictable ones from the one the replacer would evict last to the next victim. StartWarmup
+   * reads the file back. The file is written under a temporary name and renamed, so that a crash while dumping
+   * leaves the previous dump intact.
+   * @param file_name the file to write
+   * @return false if the file could not be written
+   */
+  auto DumpResidentPages(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Start the page dumper, a background thread that calls DumpResidentPages every interval. The pages are
+   * dumped once more when the dumper is stopped, which the destructor does, so that the next start of the pool can
+   * warm up from the pages that were hot at shutdown. Does nothing if the dumper is already running.
+   * @param file_name the file to dump to
+   * @param interval time between two dumps
+   */
+  void StartPageDumper(const std::string &file_name, std::chrono::milliseconds interval = buffer_pool_dump_interval);
+
+  /** @brief Stop and join the page dumper, then dump one last time. Does nothing if the dumper is not running. */
+  void StopPageDumper();
+
+  /**
+   * @brief Start warming up the pool from a file written by DumpResidentPages, in a background thread, while the pool
+   * already serves requests.
+   *
+   * The hottest pages of the dump that fit into the pool are read in page id order, a quarter of the pool at a time,
+   * by the prefetch thread, which reads runs of consecutive pages with a single large read. Like any read-ahead, the
+   * warm-up only takes free frames and stops once the pool is full: the pages the requests brought in since the start
+   * are more current than the dump. Once all pages are in, the ones that were not fetched in the meantime are handed
+   * to the replacer again in the order of the dump, so that they are evicted in the order they would have been before
+   * the restart. Pages that do not belong to this instance or are no longer allocated are skipped.
+   *
+   * @param file_name the file to read
+   * @return the number of pages the warm-up reads at most, 0 if the file cannot be read or a warm-up was started
+   * already
+   */
+  auto StartWarmup(const std::string &file_name) -> size_t;
+
+  /** @brief Wait until the warm-up is done and join its thread. Must not run concurrently with StartWarmup. */
+  void WaitForWarmup();
+
+  /** @brief Stop the warm-up and join its thread. Pages on their way in are still read. */
+  void StopWarmup();
+
+  /** @brief Return the number of pages the warm-up read. */
+  auto GetNumWarmedPages() const -> uint64_t { return warmed_pages_; }
+
+  /** @brief Return the number of fetches of the given access type that found their page in the pool. */
+  auto GetNumHits(AccessType access_type) const -> uint64_t { return hits_[static_cast<size_t>(access_type)]; }
+
+  /** @brief Return the number of fetches of the given access type that had to read their page from disk. */
+  auto GetNumMisses(AccessType access_type) const -> uint64_t { return misses_[static_cast<size_t>(access_type)]; }
+
+  /**
+   * @brief The first half of FlushAllPages, for writing the dirty pages of several instances as a single batch: pin
+   * every dirty page and clear its dirty flag.
+   * @param[out] batch receives the page id and data of each dirty page, to be written with DiskManager::WritePages
+   * @return the pinned frames, to be handed to EndFlushAll once the batch is written
+   */
+  auto BeginFlushAll(std::vector<std::pair<page_id_t, const char *>> *batch) -> std::vector<frame_id_t>;
+
+  /**
+   * @brief The second half of FlushAllPages: unpin the frames pinned by BeginFlushAll, and wait until the evicted
+   * pages still on their way to disk are written as well, so that a sync afterwards covers them too.
+   */
+  void EndFlushAll(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * @brief The first half of DeleteSegment, for a parallel BPM to run on every instance before it deletes the segment
+   * on disk: drop the pages of the segment from the pool and from the compressed cache without writing them back.
+   * Evicted pages of the segment that are still on their way to disk are waited for first.
+   * @param segment id of the segment
+   * @return false if a page of the segment is pinned, in which case no page is dropped
+   */
+  auto DiscardSegment(segment_id_t segment) -> bool;
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -59,9 +211,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @brief Create a new page in the buffer pool. Set page_id to the new page's id, or nullptr if all frames
    * are currently in use and not evictable (in another word, pinned).
    *
-   * You should pick the replacement frame from either the free list or the replacer (always find from the free list
-   * first), and then call the AllocatePage() method to get a new page id. If the replacement frame has a dirty page,
-   * you should write it back to the disk first. You also need to reset the memory and metadata for the new page.
+   * You should call the AllocatePage() method to get a new page id, and then pick the replacement frame from either
+   * the free list or the replacer (always find from the free list first); if there is no frame, give the page id back
+   * with DeallocatePage(). If the replacement frame has a dirty page, you should write it back to the disk first. You
+   * also need to reset the memory and metadata for the new page.
    *
    * Remember to "Pin" the frame by calling replacer.SetEvictable(frame_id, false)
    * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
@@ -72,6 +225,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Create a new page like NewPgImp(page_id_t *), placed on disk after near_page_id if there is room.
+   * @param[out] page_id id of created page
+   * @param near_page_id the page the new page should follow on disk
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -90,6 +251,15 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch the requested page, passing the type of access on to the replacer. Pages fetched for a Scan are
+   * admitted at the cold end of the replacer and do not gain history on hits, so that scans do not evict the hot set.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -121,60 +291,382 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the dirty pages in the buffer pool to disk, and sync the database file once they are all
+   * written. Clean pages are not written, and the dirty ones go to disk in page id order, consecutive pages with a
+   * single write; see DiskManager::WritePages.
    */
   void FlushAllPgsImp() override;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool and free it on disk. If page_id is not in the buffer pool, only free it
+   * on disk and return true. If the page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
    * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * free the page on the disk, so that its id is reused by a later NewPgImp().
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /**
+   * @brief Start background reads of the given pages.
+   *
+   * Every page that is neither resident nor being written back gets a frame right away, exactly like a miss in
+   * FetchPgImp, and is handed to the prefetch thread, which does the write-back of the victim and the read. The frame
+   * stays pinned by the prefetch until the read is done, so a FetchPage that arrives in the meantime simply waits for
+   * it. At most a quarter of the pool is tied up by prefetches at any time; pages beyond that are skipped.
+   *
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Grow or shrink the pool, see BufferPoolManager::Resize. The pool never grows past max_pool_size_: the
+   * page headers and the address space of the frames are reserved for that many frames up front, so that a page never
+   * moves while it may be pinned. Growing hands the reserved frames out; shrinking empties the frames at the end of
+   * the pool and gives their memory back to the OS.
+   * @param pool_size the new number of frames, between 1 and max_pool_size_
+   * @return false if pool_size is out of range
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
 
+  /** @brief Create a segment through the disk manager. */
+  auto NewSegmentImp() -> segment_id_t override;
+
+  /**
+   * @brief Drop the pages of the segment with DiscardSegment, then delete the segment on disk.
+   * @param segment id of the segment, not DEFAULT_SEGMENT_ID
+   * @return false if a page of the segment is pinned, or there is no such segment
+   */
+  auto DeleteSegmentImp(segment_id_t segment) -> bool override;
+
+  /** Number of frames pages are placed in. Frames from here on are being emptied by a shrinking Resize. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames reserved, the most the pool can grow to. */
+  const size_t max_pool_size_;
+  /** Number of frames that may hold a page, pool_size_ unless Resize is emptying frames. Guarded by latch_. */
+  size_t num_frames_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+
+  /**
+   * Lifecycle of a frame. Disk I/O for a frame is done without holding latch_, while the frame is in one of the
+   * transient states; the frame is pinned for the whole time so that it cannot be chosen as a victim again.
+   *
+   *   FREE / RESIDENT --(victim is dirty, or goes to the compressed cache)--> WRITING_BACK --> LOADING --> RESIDENT
+   *   FREE / RESIDENT --(victim is clean)--> LOADING --> RESIDENT
+   */
+  enum class FrameState {
+    /** The frame is on the free list. */
+    FREE,
+    /**
+     * The frame already belongs to its new page, but the evicted page is still being written out if it is dirty and
+     * put into the compressed cache.
+     */
+    WRITING_BACK,
+    /** The frame's page is being read from disk (or zeroed, for a new page). */
+    LOADING,
+    /** The frame's contents are valid. */
+    RESIDENT,
+  };
+
+  /** Book-keeping for a frame that is not part of Page. */
+  struct FrameHeader {
+    /**
+     * Protects state_ and the transitions of the frame's page: changing its page id, pinning and unpinning it,
+     * setting and clearing its dirty flag, and the replacer calls that go with them. Taken after latch_.
+     */
+    std::mutex latch_;
+    /** Guarded by latch_ of the frame. */
+    FrameState state_{FrameState::FREE};
+    /** Signaled whenever the frame leaves a transient state. Waited on with latch_ of the frame. */
+    std::condition_variable io_done_;
+    /** True if the warm-up read the page and nobody fetched it since. Guarded by latch_ of the frame. */
+    bool warm_{false};
+  };
+
+  /** The page data of all the frames. */
+  std::unique_ptr<FrameMemory> frame_memory_;
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Per-frame state, indexed by frame id. */
+  std::unique_ptr<FrameHeader[]> frames_;
+  /**
+   * Pages that were evicted but are still being written back or compressed, mapped to the frame doing it. Fetching
+   * such a page has to wait, otherwise it could read a stale copy from disk or miss it in the compressed cache.
+   */
+  std::unordered_map<page_id_t, frame_id_t> writeback_;
+  /** Signaled whenever a write-back finishes, waited on with latch_. */
+  std::condition_variable writeback_done_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
+  /** The second tier of the pool, nullptr if there is none. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
   /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  LogManager *log_manager_;
+  /** Page table for keeping track of buffer pool pages. Written under latch_. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  std::unique_ptr<Replacer> replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects frame allocation and eviction: the free list, writes to the page table, Evict and Remove on
+   * the replacer, and writeback_. A page id only changes with both latch_ and the frame's latch held. Fetching a
+   * resident page and unpinning a page only take the frame's latch, see PinResident. Never held across disk I/O.
+   */
   std::mutex latch_;
 
+  /** Serializes Resize calls. Taken before latch_. */
+  std::mutex resize_latch_;
+  /** Signaled when a page in a frame that Resize is emptying is unpinned, waited on with latch_. */
+  std::condition_variable frame_unpinned_;
+
+  /** The page cleaner thread, nullptr if the cleaner is not running. */
+  std::unique_ptr<std::thread> cleaner_thread_;
+  /** True while the page cleaner should keep running. Guarded by latch_. */
+  bool cleaner_running_{false};
+  /** Share of evictable and free frames the page cleaner keeps clean. */
+  double clean_ratio_{PAGE_CLEANER_CLEAN_RATIO};
+  /** Time between two rounds of the page cleaner. */
+  std::chrono::milliseconds cleaner_interval_{page_cleaner_interval};
+  /** Wakes up the page cleaner, waited on with latch_. */
+  std::condition_variable cleaner_cv_;
+  /** Number of dirty pages written back by the page cleaner. */
+  std::atomic<uint64_t> background_writebacks_{0};
+  /** Number of dirty victims written back by NewPgImp or FetchPgImp. */
+  std::atomic<uint64_t> foreground_writebacks_{0};
+
+  /** A prefetch whose frame has been assigned, but whose write-back and read are still to be done. */
+  struct PrefetchRequest {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    page_id_t victim_page_id_;
+    bool victim_dirty_;
+  };
+  /** Prefetches waiting for the prefetch thread. Guarded by latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Number of frames pinned by queued or running prefetches. Guarded by latch_. */
+  size_t prefetches_in_flight_{0};
+  /** The prefetch thread, started by the first prefetch. */
+  std::unique_ptr<std::thread> prefetch_thread_;
+  /** True while the prefetch thread should keep running. Guarded by latch_. */
+  bool prefetch_running_{false};
+  /** Wakes up the prefetch thread, waited on with latch_. */
+  std::condition_variable prefetch_cv_;
+  /** Number of pages read by the prefetch thread. */
+  std::atomic<uint64_t> prefetches_{0};
+  /** Signaled when prefetches_in_flight_ drops to zero, waited on with latch_. */
+  std::condition_variable prefetches_done_;
+
+  /** The page dumper thread, nullptr if the dumper is not running. */
+  std::unique_ptr<std::thread> dumper_thread_;
+  /** True while the page dumper should keep running. Guarded by latch_. */
+  bool dumper_running_{false};
+  /** The file the page dumper writes. */
+  std::string dump_file_;
+  /** Time between two dumps of the page dumper. */
+  std::chrono::milliseconds dump_interval_{buffer_pool_dump_interval};
+  /** Wakes up the page dumper, waited on with latch_. */
+  std::condition_variable dumper_cv_;
+
+  /** The warm-up thread, nullptr if no warm-up was started or it was joined. */
+  std::unique_ptr<std::thread> warmup_thread_;
+  /** True while the warm-up should keep going. Guarded by latch_. */
+  bool warmup_running_{false};
+  /** Number of pages read by the warm-up. */
+  std::atomic<uint64_t> warmed_pages_{0};
+  /** Fetches that hit and missed, indexed by AccessType. */
+  std::array<std::atomic<uint64_t>, 4> hits_{};
+  std::array<std::atomic<uint64_t>, 4> misses_{};
+
+  /**
+   * @brief Empty the frames from pool_size_ to num_frames_ for a shrinking Resize: drop the clean pages, write back
+   * the dirty ones first and wait for the pinned ones. Caller must hold latch_, which is released while waiting.
+   * @param lock the locked lock on latch_
+   */
+  void EmptyRetiredFrames(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * @brief Pin the page if it is in the pool, without taking latch_. The page table lookup is lock-free; the pin is
+   * taken under the frame's latch, after checking that the frame still holds the page. The page may still be on its
+   * way in, see WaitUntilResident.
+   * @param page_id the page to pin
+   * @param access_type the access that the page is pinned for
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page was pinned, false if it is not in the pool
+   */
+  auto PinResident(page_id_t page_id, AccessType access_type, frame_id_t *frame_id) -> bool;
+
+  /** @brief Wait until the I/O that brings the page of a pinned frame in is done. */
+  void WaitUntilResident(frame_id_t frame_id);
+
+  /** @brief Mark the I/O of the frame as done and wake up the threads waiting for it. */
+  void FinishIo(frame_id_t frame_id);
+
+  /**
+   * @brief Take a frame from the free list, or evict one if the free list is empty. Caller must hold latch_.
+   *
+   * A victim from the replacer was unpinned when the replacer picked it, but PinResident may have pinned it again
+   * before the frame's latch is taken here. Such a frame is handed back to the replacer and the next victim is tried.
+   *
+   * @param[out] frame_id the acquired frame
+   * @param[out] frame_lock holds the latch of the acquired frame when this returns true
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *frame_lock) -> bool;
+
+  /**
+   * @brief Hand an acquired frame over to a new page: unmap the old page, remember it in writeback_ if it is dirty or
+   * goes to the compressed cache, map the new page, pin the frame and move it into WRITING_BACK or LOADING. Caller
+   * must hold latch_ and the latch of the frame.
+   * @param frame_id the acquired frame
+   * @param page_id the page that will live in the frame
+   * @param access_type the access that the page is brought in for
+   * @param[out] victim_page_id the page that must be written back or compressed first, INVALID_PAGE_ID if none
+   * @param[out] victim_dirty true if the victim is dirty and must be written back
+   */
+  void AssignFrame(frame_id_t frame_id, page_id_t page_id, AccessType access_type, page_id_t *victim_page_id,
+                   bool *victim_dirty);
+
+  /**
+   * @brief Write out the evicted page that is still in the frame if it is dirty, put it into the compressed cache,
+   * then move the frame to LOADING. Must be called without holding latch_.
+   * @param frame_id the frame whose previous page is written back
+   * @param victim_page_id the page to write back
+   * @param victim_dirty true if the page must be written to disk
+   */
+  void WriteBackVictim(frame_id_t frame_id, page_id_t victim_page_id, bool victim_dirty);
+
+  /**
+   * @brief Bring a page into a frame: from the compressed cache if it is there, otherwise from disk.
+   * @param page_id the page to read
+   * @param[out] page_data the data of the frame
+   */
+  void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * @brief The second half of WriteBackVictim, once the write is done: forget the page in writeback_, wake up its
+   * fetchers and move the frame to LOADING. Must be called without holding latch_.
+   */
+  void FinishWriteBack(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * @brief Write the page in a resident frame to disk and clear its dirty flag. The frame is pinned while the write
+   * is in progress, latch_ is released for the write and held again when this returns.
+   * @param lock the locked lock on latch_
+   * @param frame_id the frame to write back
+   */
+  void FlushFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * @brief FlushFrame for several frames at once. The pages are written as one batch with DiskManager::WritePages,
+   * which coalesces consecutive pages and keeps the other writes in flight together.
+   * @param lock the locked lock on latch_
+   * @param frame_ids the frames to write back, each of them resident
+   */
+  void FlushFrames(std::unique_lock<std::mutex> *lock, const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * @brief Pin the frames so that they cannot be evicted while they are written. Caller must hold latch_.
+   */
+  void PinForFlush(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * @brief Wait until the pinned frames are resident and clear their dirty flags. Must be called without latch_.
+   * @return the page id and data of each frame, for DiskManager::WritePages
+   */
+  auto ClaimForFlush(const std::vector<frame_id_t> &frame_ids) -> std::vector<std::pair<page_id_t, const char *>>;
+
+  /**
+   * @brief Unpin the frames pinned by PinForFlush once they are written. Must be called without latch_.
+   */
+  void UnpinAfterFlush(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * @brief Return true if the page may be written to disk now, i.e. logging is disabled or every log record up to
+   * the page LSN is already persistent (write-ahead logging).
+   */
+  auto IsLogPersistent(Page *page) -> bool;
+
+  /**
+   * @brief Flush the log up to the given page LSN unless it is persistent already, so that a page with that LSN may
+   * be written to disk. Must be called without latch_.
+   */
+  void FlushLogUpTo(lsn_t lsn);
+
+  /**
+   * @brief Return true if the value at OFFSET_LSN of a page can be the LSN of a log record, i.e. the log manager has
+   * handed it out already; a page that is not logged holds anything there.
+   */
+  auto IsHandedOut(lsn_t lsn) -> bool;
+
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Pick the dirty frames the page cleaner should write back this round. Caller must hold latch_.
+   * @return frames in eviction order, the next victim first
+   */
+  auto PickFramesToClean() -> std::vector<frame_id_t>;
+
+  /** @brief Body of the page cleaner thread. */
+  void RunPageCleaner();
+
+  /**
+   * @brief Give a free or evicted frame to the page and queue its read for the prefetch thread, unless the page is
+   * resident or being written back already. Caller must hold latch_ and call WakePrefetcher afterwards.
+   * @param page_id the page to read ahead
+   * @param[out] frame_id the frame the page is read into
+   * @return true if the read was queued
+   */
+  auto QueuePrefetch(page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /** @brief Start the prefetch thread if it is not running yet and wake it up. Caller must hold latch_. */
+  void WakePrefetcher();
+
+  /** @brief Body of the prefetch thread. Keeps going until it is stopped and the queue is drained. */
+  void RunPrefetcher();
+
+  /** @brief Body of the page dumper thread. */
+  void RunPageDumper();
+
+  /**
+   * @brief Body of the warm-up thread.
+   * @param page_ids the pages to read, hottest first
+   */
+  void RunWarmup(std::vector<page_id_t> page_ids);
+
+  /**
+   * @brief Allocate a page on disk through the disk manager's free space map. Each instance only gets the ids that
+   * are its index modulo the number of instances. Must be called without holding latch_.
+   * @param near_page_id the page the new page should follow on disk, INVALID_PAGE_ID if it does not matter
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions
+   * to validate input data and ensure that a parallel BPM is routing requests to the BPIs correctly.
+   * @param page_id page_id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Take the page out of an unpinned frame without writing it back, and put the frame on the free list unless
+   * Resize is emptying it. Caller must hold latch_ and the frame's latch.
+   * @param frame_id the frame to free
+   */
+  void FreeFrame(frame_id_t frame_id);
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that its id can be allocated again. Must be called without holding latch_.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   // TODO(student): You may add additional private members and helper functions
 };
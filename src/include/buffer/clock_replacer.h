@@ -12,17 +12,20 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The frames form a circle with a reference bit each. An access sets the bit. The clock hand sweeps over the evictable
+ * frames, clearing set bits, and evicts the first frame whose bit is already clear. Scan accesses never set the bit.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +35,44 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  struct ClockNode {
+    bool tracked_{false};
+    bool is_evictable_{false};
+    /** The reference bit. */
+    bool referenced_{false};
+  };
+
+  size_t num_pages_;
+  /** Number of evictable frames. */
+  size_t curr_size_{0};
+  /** The frame the clock hand points at. */
+  size_t hand_{0};
+  /** Per-frame state, indexed by frame id. */
+  std::vector<ClockNode> nodes_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier below the buffer pool: pages the pool drops are kept here compressed with
+ * PageCodec, and a miss in the pool decompresses the page from here instead of reading it from disk. A page is only
+ * ever in one of the two tiers, a page found here is taken out again, so the cache never holds a stale copy of a page
+ * that was modified in the pool.
+ *
+ * The cache holds up to capacity bytes of compressed pages and drops the least recently inserted ones to make room.
+ * Pages that do not compress to at most MAX_COMPRESSED_SIZE are not kept, they would not save enough memory to pay for
+ * the decompression. Thread-safe; compression and decompression run without holding the latch.
+ */
+class CompressedPageCache {
+ public:
+  /** Largest compressed page the cache keeps. */
+  static constexpr size_t MAX_COMPRESSED_SIZE = BUSTUB_PAGE_SIZE * 3 / 4;
+
+  /**
+   * @brief Create a new CompressedPageCache.
+   * @param capacity the number of bytes of compressed page data the cache holds at most
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  /**
+   * @brief Compress a page and keep it, replacing an older copy of the page.
+   * @param page_id id of the page
+   * @param page_data the page, BUSTUB_PAGE_SIZE bytes
+   * @return false if the page does not compress well enough and was not kept
+   */
+  auto Insert(page_id_t page_id, const char *page_data) -> bool;
+
+  /**
+   * @brief Take a page out of the cache and decompress it.
+   * @param page_id id of the page
+   * @param[out] page_data receives the page, BUSTUB_PAGE_SIZE bytes
+   * @return false if the page is not in the cache
+   */
+  auto Lookup(page_id_t page_id, char *page_data) -> bool;
+
+  /** @brief Drop the page if it is in the cache, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** @brief Drop every page with an id in [begin, end), e.g. the pages of a deleted segment. */
+  void EraseRange(page_id_t begin, page_id_t end);
+
+  /** @return the number of bytes of compressed page data in the cache */
+  auto GetSize() -> size_t;
+
+  /** @return the number of pages in the cache */
+  auto GetNumPages() -> size_t;
+
+  /** @return the number of lookups that found their page */
+  auto GetNumHits() const -> uint64_t { return hits_; }
+
+  /** @return the number of lookups that did not find their page */
+  auto GetNumMisses() const -> uint64_t { return misses_; }
+
+  /** @return the number of pages that were kept by Insert */
+  auto GetNumInsertions() const -> uint64_t { return insertions_; }
+
+  /** @return the number of pages that Insert did not keep because they did not compress well enough */
+  auto GetNumRejections() const -> uint64_t { return rejections_; }
+
+  /** @return the number of pages dropped to make room for others */
+  auto GetNumEvictions() const -> uint64_t { return evictions_; }
+
+  /** @return the time spent compressing pages, in nanoseconds */
+  auto GetCompressNanos() const -> uint64_t { return compress_nanos_; }
+
+  /** @return the time spent decompressing pages, in nanoseconds */
+  auto GetDecompressNanos() const -> uint64_t { return decompress_nanos_; }
+
+ private:
+  struct Entry {
+    /** The compressed page. */
+    std::string data_;
+    /** Position of the page in lru_. */
+    std::list<page_id_t>::iterator lru_;
+  };
+
+  /** Drop an entry. Caller must hold latch_. @return the compressed page of the entry */
+  auto EraseEntry(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string;
+
+  const size_t capacity_;
+  /** Protects entries_, lru_ and size_. */
+  std::mutex latch_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** The cached pages, the most recently inserted first. */
+  std::list<page_id_t> lru_;
+  /** Bytes of compressed page data in entries_. */
+  size_t size_{0};
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> insertions_{0};
+  std::atomic<uint64_t> rejections_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> compress_nanos_{0};
+  std::atomic<uint64_t> decompress_nanos_{0};
+};
+
+}  // namespace bustub
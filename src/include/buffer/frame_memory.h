@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory.h
+//
+// Identification: src/include/buffer/frame_memory.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** How the memory of the frames is backed. */
+enum class HugePageMode {
+  /** Regular 4 KB pages. */
+  NONE,
+  /** Regular pages, with transparent huge pages requested through madvise. */
+  TRANSPARENT,
+  /** Explicit huge pages from the kernel's hugetlb pool. */
+  EXPLICIT,
+};
+
+/**
+ * FrameMemory is the page data of all the frames of a buffer pool, as one anonymous mapping. Every frame starts at a
+ * multiple of BUSTUB_PAGE_SIZE from a page-aligned address, so frames can be the buffers of O_DIRECT reads and writes.
+ *
+ * Pools of at least one huge page are backed by huge pages where the system has them, which cuts the TLB misses of
+ * touching many frames: explicit huge pages if some are reserved, otherwise transparent huge pages. The mapping is
+ * zeroed and only takes up memory once a frame is first touched.
+ *
+ * A pool that may grow maps the address space of its largest size up front, so frames never move; Release gives the
+ * memory of frames that are no longer used back to the OS. Explicit huge pages are taken from the kernel when they are
+ * mapped, so such pools only use transparent huge pages.
+ */
+class FrameMemory {
+ public:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Map the memory of the frames.
+   * @param num_frames number of frames
+   * @param max_frames number of frames the pool may grow to, at least num_frames
+   */
+  explicit FrameMemory(size_t num_frames, size_t max_frames = 0);
+
+  ~FrameMemory();
+
+  DISALLOW_COPY_AND_MOVE(FrameMemory);
+
+  /** @return the page data of the frame */
+  auto FrameData(frame_id_t frame_id) const -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /**
+   * Give the memory of the frames back to the OS. The frames read as zeros afterwards.
+   * @param first_frame_id the first frame to release
+   * @param num_frames number of frames to release
+   */
+  void Release(frame_id_t first_frame_id, size_t num_frames);
+
+  /** @return the number of bytes mapped, which is the memory the frames take once every frame was touched */
+  auto GetSize() const -> size_t { return size_; }
+
+  /** @return how the memory is backed */
+  auto GetHugePageMode() const -> HugePageMode { return huge_page_mode_; }
+
+ private:
+  char *data_{nullptr};
+  size_t size_{0};
+  HugePageMode huge_page_mode_{HugePageMode::NONE};
+};
+
+}  // namespace bustub
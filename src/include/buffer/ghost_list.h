@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages in eviction order, oldest first, without their data. The 2Q
+ * and ARC replacers use it to recognize a page that is read again shortly after it was evicted. Not thread safe.
+ */
+class GhostList {
+ public:
+  /** @return true if the page is in the list */
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+
+  /**
+   * Remove the page from the list.
+   * @return true if the page was in the list
+   */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  /** Append the page as the most recently evicted one. */
+  void PushBack(page_id_t page_id) {
+    Erase(page_id);
+    index_[page_id] = pages_.insert(pages_.end(), page_id);
+  }
+
+  /** Forget the oldest page. The list must not be empty. */
+  void PopFront() {
+    index_.erase(pages_.front());
+    pages_.pop_front();
+  }
+
+  /** @return the number of pages in the list */
+  auto Size() const -> size_t { return pages_.size(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
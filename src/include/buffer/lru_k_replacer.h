@@ -12,169 +12,17 @@
 
 #pragma once
 
-#include <limits>
-#include <list>
+#include <deque>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
-#include <cstdlib>
-#include<algorithm>
-#include <iostream>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
-struct node {
-	int times;
-	frame_id_t id;
-	bool evictable = true;
-	node* next, * pre;
-	node(frame_id_t id,int times=1) :times(times),id(id),next(nullptr),pre(nullptr) {}
-	
-};
-
-class my_list {
-private:
-	node* front_, * back_, * queue, * k_queue, * evict;
-	//front->q1(unevictable)->q2->q3(queue)->k1->k2(k_queue)->back
-	int _size_;
-	int cur;
-	int others;
-	int k;
-public:
-	my_list(int size,int k_){
-		_size_ = size;
-		k = k_;
-		cur = 0;
-		others=0;
-		front_ = new node(-1);
-		back_ = new node(-1);
-		front_->next = back_;
-		back_->pre = front_;
-		//
-		queue  = front_;
-		k_queue = back_;
-	}
-	~my_list(){
-		node* p = front_;
-		while(p != nullptr){
-			node *n = p->next;
-			delete p;
-			p = n;
-		}
-	}
-	node* find(frame_id_t id) {
-		node* p = front_->next;
-		while (p != back_) {
-			if (p->id == id) {
-				return p;
-			}
-			p = p->next;
-		}
-		return nullptr;
-
-	}
-	void insert(node* first, node* second, node* tar) {
-		cur++;
-		first->next = tar;
-		second->pre = tar;
-		tar->pre = first;
-		tar->next = second;
-		//
-		if(tar->times >=k){
-			
-			return;
-		}
-		if (queue == first) {
-			queue = tar;
-		}
-	}
-	void del(node* tar) {
-		tar->pre->next = tar->next;
-		tar->next->pre = tar->pre;
-		cur--;
-		//
-		if (queue == tar) {
-			queue = tar->pre;
-		}
-	}
-	void add(frame_id_t id) {
-		node* it = find(id);
-		if (!it) {
-			//not found
-			node* tmp = new node(id);
-			if (cur + others >= _size_) {
-				//need evict
-				node* p = front_->next;
-				while (!p->evictable) {
-					p = p->next;
-				}
-				del(p);
-			}
-			insert(queue, queue->next, tmp);
-		}
-		else{
-			if (++(it->times) < k) {
-				del(it);
-				insert(queue, queue->next, it);
-			}
-			else {
-				del(it);
-				insert(k_queue->pre, k_queue, it);
-				//k_queue = it;
-			}
-		}
-	}
-	bool evcit(frame_id_t *id) {
-		node* p = front_->next;
-		while (!p->evictable) {
-			p = p->next;
-		}
-		if(p==back_){
-			return false;
-		}
-		*id = p->id;
-		del(p);
-		delete p;
-		return true;
-	}
-	void remove(frame_id_t id) {
-		node* it = find(id);
-		if (it) {
-			del(it);
-			delete it;
-		}
-	}
-	void set(frame_id_t id,bool evictable) {
-		node* it = find(id);
-		if (it) {
-			if (it->evictable && !evictable) {
-				cur--;
-				others++;
-			}
-			else if (!(it->evictable) && evictable) {
-				cur++;
-				others--;
-			}
-			it->evictable = evictable;
-		}
-	}
-	int get_cur() {
-		return cur;
-	}
-	void print(){
-		node *p=front_->next;
-		while(p!=back_){
-			std::cout<<p->id<<" times:"<<p->times<<"\n";
-			p=p->next;
-		}
-		std::cout<<"end\n";
-	}
-	void p_q(){
-		std::cout<<queue->id<<" times:"<<queue->times;
-	}
-};
 
 /**
  * LRUKReplacer implements the LRU-k replacement policy.
@@ -186,30 +34,29 @@ public:
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Every frame keeps the timestamps of its last k accesses, oldest first. The oldest of them is the kth previous access
+ * for a frame with a full history and the earliest access overall for the others, so in both cases the victim is the
+ * frame with the smallest oldest timestamp. Evictable frames are kept in ordered sets keyed by that timestamp, which
+ * makes every operation O(log n) in the number of frames.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief a new LRUKReplacer.
    * @param num_frames the maximum number of frames the LRUReplacer will be required to store
+   * @param k the number of accesses the backward k-distance looks back
    */
   explicit LRUKReplacer(size_t num_frames, size_t k);
 
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer();
+  ~LRUKReplacer() override = default;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
    * that are marked as 'evictable' are candidates for eviction.
    *
@@ -217,30 +64,33 @@ class LRUKReplacer {
    * If multiple frames have inf backward k-distance, then evict the frame with the earliest
    * timestamp overall.
    *
+   * Frames that were only ever accessed by scans are evicted before all others.
+   *
    * Successful eviction of a frame should decrement the size of replacer and remove the frame's
    * access history.
    *
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Record the event that the given frame id is accessed at current timestamp.
-   * Create a new entry for access history if frame id has not been seen before.
+   * Create a new entry for access history if frame id has not been seen before. A new entry is not evictable.
    *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
+   * A Scan access does not count towards the frame's history: a frame that is not tracked yet is put first in line
+   * for eviction, and a tracked frame keeps its place. This way a large sequential scan cycles through the coldest
+   * frames instead of evicting the hot working set.
+   *
+   * If frame id is invalid (ie. larger than replacer_size_), the process is aborted.
    *
    * @param frame_id id of frame that received a new access.
+   * @param access_type type of access that was received.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+  using Replacer::RecordAccess;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Toggle whether a frame is evictable or non-evictable. This function also
    * controls replacer's size. Note that size is equal to number of evictable entries.
    *
@@ -248,18 +98,14 @@ class LRUKReplacer {
    * decrement. If a frame was previously non-evictable and is to be set to evictable,
    * then size should increment.
    *
-   * If frame id is invalid, throw an exception or abort the process.
-   *
-   * For other scenarios, this function should terminate without modifying anything.
+   * If frame id is invalid, the process is aborted. For frames without access history, this function does nothing.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Remove an evictable frame from replacer, along with its access history.
    * This function should also decrement replacer's size if removal is successful.
    *
@@ -267,36 +113,72 @@ class LRUKReplacer {
    * with largest backward k-distance. This function removes specified frame id,
    * no matter what its backward k-distance is.
    *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
+   * If Remove is called on a non-evictable frame, the process is aborted.
    *
    * If specified frame is not found, directly return from this function.
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Return replacer's size, which tracks the number of evictable frames.
    *
    * @return size_t
    */
-  auto Size() -> size_t;
-  
-  my_list* get(){
-  	return lst;
-  }
+  auto Size() -> size_t override;
+
+  /**
+   * @brief Return the evictable frames in the order in which Evict would pick them, without evicting anything.
+   * Used by the page cleaner to find the dirty frames that are about to be evicted.
+   *
+   * @param max_candidates the maximum number of frames to return
+   * @return up to max_candidates evictable frame ids, the next victim first
+   */
+  auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> override;
+
+  /**
+   * @brief Change the number of frames the replacer can track, as the buffer pool grows or shrinks. The frames
+   * that go away when shrinking must not be tracked anymore.
+   *
+   * @param num_frames the new number of frames
+   */
+  void Resize(size_t num_frames) override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
-  my_list *lst;
+  /** Access history of one frame. */
+  struct LRUKNode {
+    /** Timestamps of the last (up to) k accesses, oldest first. Empty if the frame is not tracked. */
+    std::deque<size_t> history_;
+    bool is_evictable_{false};
+    /** True if every access so far was a scan. */
+    bool scan_only_{false};
+  };
+
+  /** An evictable frame, ordered by the oldest timestamp in its history. */
+  using EvictionKey = std::pair<size_t, frame_id_t>;
+
+  /** @return the set that holds the frame while it is evictable. */
+  auto EvictionSetOf(const LRUKNode &node) -> std::set<EvictionKey> &;
+
+  /** @return the key of the frame in its eviction set. */
+  auto EvictionKeyOf(frame_id_t frame_id) const -> EvictionKey {
+    return {nodes_[frame_id].history_.front(), frame_id};
+  }
+
+  size_t current_timestamp_{0};
+  /** Number of evictable frames. */
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  /** Access history of every frame, indexed by frame id. */
+  std::vector<LRUKNode> nodes_;
+  /** Evictable frames that were only accessed by scans. Evicted first. */
+  std::set<EvictionKey> scan_frames_;
+  /** Evictable frames with fewer than k accesses, i.e. +inf backward k-distance. Evicted next. */
+  std::set<EvictionKey> inf_frames_;
+  /** Evictable frames with a full history of k accesses. Evicted last. */
+  std::set<EvictionKey> kth_frames_;
   std::mutex latch_;
 };
 
@@ -12,17 +12,22 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Evictable frames are ordered by the time of their last access. Frames that were only accessed by scans come before
+ * all others, oldest first.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -32,21 +37,50 @@ class LRUReplacer : public Replacer {
    */
   explicit LRUReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
+
   /**
    * Destroys the LRUReplacer.
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+  using Replacer::RecordAccess;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  struct LRUNode {
+    bool tracked_{false};
+    bool is_evictable_{false};
+    bool scan_only_{false};
+    size_t last_access_{0};
+  };
+
+  /** (not scan only, last access, frame id): scan-only frames sort first. */
+  using EvictionKey = std::tuple<bool, size_t, frame_id_t>;
+
+  auto EvictionKeyOf(frame_id_t frame_id) const -> EvictionKey {
+    return {!nodes_[frame_id].scan_only_, nodes_[frame_id].last_access_, frame_id};
+  }
+
+  size_t current_timestamp_{0};
+  size_t num_pages_;
+  /** Per-frame state, indexed by frame id. */
+  std::vector<LRUNode> nodes_;
+  /** Evictable frames, the next victim first. */
+  std::set<EvictionKey> evictable_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames that hold them.
+ *
+ * It is an open-addressing hash table with linear probing over a flat array of slots. Each slot is a single 64-bit
+ * atomic word that packs the page id and the frame id, so a slot is always read and written as a whole. A buffer pool
+ * never holds more pages than it has frames, so the table is sized for max_entries and only grows when the pool does,
+ * see Reserve; it is kept at most half full, which keeps probe sequences short.
+ *
+ * Find does not take any lock. Insert and Remove are serialized by a latch. Inserting only ever fills an empty slot,
+ * which a concurrent Find either sees or does not, both of which are correct. Remove keeps the probe sequences free of
+ * holes by shifting later entries back into the freed slot, and a Find that overlaps with such a shift could miss the
+ * entry being moved; Remove therefore bumps a version counter before and after it touches the slots, and Find retries
+ * whenever the version changed while it was probing. Reserve moves the entries to a larger array the same way, and
+ * keeps the old array around until the table is destroyed, since a Find may still be probing it.
+ */
+class PageTable {
+ public:
+  /**
+   * Create an empty page table.
+   * @param max_entries the largest number of pages the table will hold at any time
+   */
+  explicit PageTable(size_t max_entries);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Look up the frame of a page. Lock-free.
+   * @param page_id id of the page
+   * @param[out] frame_id frame that holds the page
+   * @return true if the page is in the table
+   */
+  auto Find(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+    while (true) {
+      const uint64_t version = version_.load(std::memory_order_acquire);
+      if ((version & 1) == 0) {
+        const Slots *table = table_.load(std::memory_order_acquire);
+        uint64_t slot = EMPTY_SLOT;
+        for (size_t i = table->HomeOf(page_id);; i = (i + 1) & table->mask_) {
+          slot = table->slots_[i].load(std::memory_order_acquire);
+          if (slot == EMPTY_SLOT || PageOf(slot) == page_id) {
+            break;
+          }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version_.load(std::memory_order_relaxed) == version) {
+          if (slot == EMPTY_SLOT) {
+            return false;
+          }
+          frame_id = FrameOf(slot);
+          return true;
+        }
+      }
+    }
+  }
+
+  /**
+   * Map the page to the frame, replacing the previous mapping of the page if there is one.
+   * @param page_id id of the page
+   * @param frame_id frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the page from the table.
+   * @param page_id id of the page
+   * @return true if the page was in the table
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /**
+   * Make room for max_entries pages, growing the table if it is too small. Never shrinks the table.
+   * @param max_entries the largest number of pages the table will hold at any time from now on
+   */
+  void Reserve(size_t max_entries);
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  /** A slot that holds no page. Page id INVALID_PAGE_ID is never stored, so no occupied slot looks like this. */
+  static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+
+  static auto MakeSlot(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & UINT32_MAX); }
+
+  /** An array of slots, with enough of them for max_entries pages. */
+  struct Slots {
+    explicit Slots(size_t max_entries);
+
+    /** @return the first slot of the page's probe sequence */
+    auto HomeOf(page_id_t page_id) const -> size_t {
+      // Fibonacci hashing: page ids are mostly dense, the multiplication spreads neighbours over the whole table.
+      return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                                 shift_);
+    }
+
+    /** @return the slot that holds the page, or the empty slot that ends its probe sequence. Writers only. */
+    auto SlotOf(page_id_t page_id) const -> size_t;
+
+    /** Number of slots minus one; the number of slots is a power of two. */
+    size_t mask_;
+    /** 64 minus log2 of the number of slots, turns a 64-bit hash into a slot index. */
+    int shift_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  };
+
+  /** The slots in use. */
+  std::atomic<Slots *> table_;
+  /** Every array of slots the table ever used, the one in use last. Written under write_latch_. */
+  std::vector<std::unique_ptr<Slots>> tables_;
+  /** Odd while Remove or Reserve is moving entries around. */
+  std::atomic<uint64_t> version_{0};
+  std::atomic<size_t> size_{0};
+  /** Serializes Insert and Remove. */
+  std::mutex write_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,212 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool over several BufferPoolManagerInstances so that threads working on
+ * different pages do not contend on a single latch. A page always lives in the instance `page_id % num_instances`,
+ * and every instance only allocates page ids that map back to itself.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacement_policy the replacement policy of each instance
+   * @param max_pool_size the size each instance may grow to with Resize, 0 for pool_size
+   * @param compressed_cache_size bytes of the compressed page cache of each instance, 0 for none
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacementPolicy replacement_policy = ReplacementPolicy::LRU_K, size_t max_pool_size = 0,
+                            size_t compressed_cache_size = 0);
+
+  /**
+   * @brief Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override = default;
+
+  /** @brief Return the total number of frames over all the instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /** @brief Return the number of instances the pool is sharded into. */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * @brief Return the instance responsible for handling the given page id.
+   * @param page_id page id
+   * @return pointer to the BufferPoolManagerInstance responsible for handling the given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /** @brief Start a page cleaner on every instance, see BufferPoolManagerInstance::StartPageCleaner. */
+  void StartPageCleaner(double clean_ratio = PAGE_CLEANER_CLEAN_RATIO,
+                        std::chrono::milliseconds interval = page_cleaner_interval);
+
+  /** @brief Stop the page cleaners of all instances. */
+  void StopPageCleaner();
+
+  /** @brief Return the number of dirty pages the page cleaners of all instances wrote back. */
+  auto GetBackgroundWritebacks() const -> uint64_t;
+
+  /** @brief Return the number of dirty victims that misses of all instances still had to write back themselves. */
+  auto GetForegroundWritebacks() const -> uint64_t;
+
+  /**
+   * @brief Dump the resident pages of every instance, see BufferPoolManagerInstance::DumpResidentPages. Instance i
+   * writes to file_name followed by ".i".
+   * @return false if the file of an instance could not be written
+   */
+  auto DumpResidentPages(const std::string &file_name) -> bool;
+
+  /** @brief Start a page dumper on every instance, each writing its own file like DumpResidentPages. */
+  void StartPageDumper(const std::string &file_name, std::chrono::milliseconds interval = buffer_pool_dump_interval);
+
+  /** @brief Stop the page dumpers of all instances. */
+  void StopPageDumper();
+
+  /**
+   * @brief Start the warm-up of every instance from the files written by DumpResidentPages.
+   * @return the number of pages the warm-ups read at most
+   */
+  auto StartWarmup(const std::string &file_name) -> size_t;
+
+  /** @brief Wait until the warm-ups of all instances are done. */
+  void WaitForWarmup();
+
+  /** @brief Stop the warm-ups of all instances. */
+  void StopWarmup();
+
+  /** @brief Return the number of pages the warm-ups of all instances read. */
+  auto GetNumWarmedPages() const -> uint64_t;
+
+ protected:
+  /**
+   * @brief Fetch the requested page from the instance that owns it.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Fetch the requested page from the instance that owns it, for the given type of access.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
+  /**
+   * @brief Unpin the target page from the instance that owns it.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Create a new page. Instances are asked in round robin order, starting one past the instance that served
+   * the previous call, so that new pages (and their page ids) are spread evenly over the shards.
+   * @param[out] page_id id of created page
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * @brief Create a new page, starting with the instance that owns the page id right after near_page_id, so that
+   * the new page can follow it on disk.
+   * @param[out] page_id id of created page
+   * @param near_page_id the page the new page should follow on disk
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, page_id_t near_page_id) -> Page * override;
+
+  /**
+   * @brief Delete a page from the instance that owns it.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush the dirty pages of every instance to disk and sync the database file. The instances own interleaved
+   * page ids, so their dirty pages are written as a single batch, in which consecutive pages of different instances
+   * are coalesced into one write.
+   */
+  void FlushAllPgsImp() override;
+
+  /**
+   * @brief Split the pages by the instance that owns them and let every instance prefetch its share.
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Split the new size evenly over the instances and resize each of them; an instance gets one frame more
+   * than the others if the size does not divide evenly.
+   * @param pool_size the new total number of frames
+   * @return false if an instance cannot take its share, in which case no instance is resized
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
+
+  /** @brief Create a segment through the shared disk manager. */
+  auto NewSegmentImp() -> segment_id_t override;
+
+  /**
+   * @brief Drop the pages of the segment from every instance, then delete the segment on disk.
+   * @param segment id of the segment, not DEFAULT_SEGMENT_ID
+   * @return false if a page of the segment is pinned, or there is no such segment
+   */
+  auto DeleteSegmentImp(segment_id_t segment) -> bool override;
+
+ private:
+  /** @return the file of the instance for DumpResidentPages and StartWarmup */
+  static auto InstanceFileName(const std::string &file_name, size_t instance_index) -> std::string {
+    return file_name + "." + std::to_string(instance_index);
+  }
+
+  /** The shards of this buffer pool. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** Total number of frames over the shards. */
+  std::atomic<size_t> pool_size_;
+  /** The disk manager shared by all the shards. */
+  DiskManager *disk_manager_;
+  /** Instance that NewPgImp starts from on its next call. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -12,12 +12,48 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Why a page is being accessed. The buffer pool passes this on to the replacer, so that one-off accesses such as
+ * sequential scans do not push the hot working set out of the pool.
+ */
+enum class AccessType {
+  /** Nothing is known about the access, treat it as a regular access. */
+  Unknown = 0,
+  /** A point lookup. */
+  Lookup,
+  /** A page read by a sequential scan; it is unlikely to be read again soon. */
+  Scan,
+  /** An index page. */
+  Index,
+};
+
+/** The replacement policies a buffer pool can be built with, see MakeReplacer. */
+enum class ReplacementPolicy {
+  /** Least recently used. */
+  LRU,
+  /** LRU-K, evicts the frame with the largest backward k-distance. The default. */
+  LRU_K,
+  /** CLOCK, the one-bit approximation of LRU. */
+  CLOCK,
+  /** 2Q, a FIFO probation queue in front of an LRU main queue, with a ghost queue of recently evicted pages. */
+  TWO_Q,
+  /** ARC, LRU lists for pages seen once and seen twice whose split adapts to hits in their ghost lists. */
+  ARC,
+};
+
+/**
+ * Replacer is an abstract class that tracks page usage and picks the frame to evict.
+ *
+ * A frame is tracked from its first RecordAccess until it is evicted or removed. Tracked frames start out as not
+ * evictable; the buffer pool marks them evictable once their pin count drops to zero. Frame ids must be smaller than
+ * the number of frames the replacer was created for.
  */
 class Replacer {
  public:
@@ -25,26 +61,76 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Evict a frame as defined by the replacement policy. Only evictable frames are candidates. The frame's access
+   * history is dropped, but policies with ghost lists remember the page that was in it.
+   * @param[out] frame_id id of frame that was evicted
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to the frame, starting to track it if it was not tracked yet. A Scan access does not promote a
+   * tracked frame, and a frame whose first access is a Scan is among the first to be evicted.
+   * @param frame_id id of the accessed frame
+   * @param access_type type of the access
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type) = 0;
+
+  /**
+   * Record a regular access to the frame.
+   * @param frame_id id of the accessed frame
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  void RecordAccess(frame_id_t frame_id) { RecordAccess(frame_id, AccessType::Unknown); }
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Mark a tracked frame as evictable or not. Does nothing for frames that are not tracked.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Stop tracking an evictable frame, without remembering its page in any ghost list; the page is gone. Does nothing
+   * for frames that are not tracked, aborts for frames that are not evictable.
+   * @param frame_id id of the frame
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Return the evictable frames in the order in which Evict would pick them if no other accesses happened, without
+   * evicting anything.
+   * @param max_candidates the maximum number of frames to return
+   * @return up to max_candidates evictable frame ids, the next victim first
+   */
+  virtual auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Change the number of frames, as the buffer pool grows or shrinks. The frames that go away when shrinking must not
+   * be tracked anymore.
+   * @param num_frames the new number of frames
+   */
+  virtual void Resize(size_t num_frames) = 0;
+
+  /**
+   * Tell the replacer which page is about to be loaded into a frame that is not tracked. Policies that keep ghost
+   * lists of evicted pages use this to recognize a page that comes back. Called before the first RecordAccess of the
+   * frame.
+   * @param frame_id id of the frame
+   * @param page_id id of the page that goes into the frame
+   */
+  virtual void SetFramePage(frame_id_t frame_id, page_id_t page_id) {}
 };
 
+/**
+ * Create a replacer for the given policy.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer has to track
+ * @param k the lookback constant; only used by LRU_K
+ * @return the new replacer
+ */
+auto MakeReplacer(ReplacementPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full version of the 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A page that is loaded for the first time enters A1in, a FIFO queue holding about a quarter of the frames; further
+ * accesses while it is in A1in do not move it. When it is evicted from A1in, its id is remembered in the ghost queue
+ * A1out, which covers about half as many pages as there are frames. A page that is loaded again while it is still in
+ * A1out has proven to be hot and enters Am, an LRU queue. Frames are evicted from A1in while it is over its share,
+ * and from Am otherwise, so a one-pass scan only ever churns A1in.
+ *
+ * Scan accesses never promote a frame, and pages that were only scanned leave no trace in A1out.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+  using Replacer::RecordAccess;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_candidates) -> std::vector<frame_id_t> override;
+
+  void Resize(size_t num_frames) override;
+
+  void SetFramePage(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  enum class Queue { A1IN, AM };
+
+  struct TwoQNode {
+    bool tracked_{false};
+    bool is_evictable_{false};
+    Queue queue_{Queue::A1IN};
+    /** True if the frame was only scanned, so its page does not go to A1out. */
+    bool scan_only_{false};
+    /** Admission time in A1in, last access time in Am. */
+    size_t timestamp_{0};
+    /** The page in the frame, as told by SetFramePage. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  using EvictionKey = std::pair<size_t, frame_id_t>;
+
+  auto EvictionSetOf(const TwoQNode &node) -> std::set<EvictionKey> & {
+    return node.queue_ == Queue::A1IN ? a1in_ : am_;
+  }
+
+  auto EvictionKeyOf(frame_id_t frame_id) const -> EvictionKey { return {nodes_[frame_id].timestamp_, frame_id}; }
+
+  /** @return true if the next victim comes from A1in */
+  auto EvictFromA1in() const -> bool { return !a1in_.empty() && (am_.empty() || a1in_size_ > kin_); }
+
+  size_t current_timestamp_{0};
+  size_t num_frames_;
+  /** Target number of frames in A1in. */
+  size_t kin_;
+  /** Maximum number of pages in A1out. */
+  size_t kout_;
+  /** Number of frames in A1in, evictable or not. */
+  size_t a1in_size_{0};
+  /** Per-frame state, indexed by frame id. */
+  std::vector<TwoQNode> nodes_;
+  /** Evictable frames in A1in, by admission time. */
+  std::set<EvictionKey> a1in_;
+  /** Evictable frames in Am, by last access time. */
+  std::set<EvictionKey> am_;
+  /** Pages recently evicted from A1in. */
+  GhostList a1out_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -39,7 +39,15 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance on top of the given database file.
+   * @param db_file_name the database file
+   * @param buffer_pool_instances number of shards of the buffer pool. With more than one shard, a
+   * ParallelBufferPoolManager is used so that concurrent queries do not serialize on a single buffer pool latch.
+   * @param warm_restart true to dump the resident pages to `<db>.bpdump` periodically and at shutdown, and to warm the
+   * buffer pool up from that dump on startup
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t buffer_pool_instances = 1, bool warm_restart = false);
 
   ~BustubInstance();
 
@@ -73,6 +81,10 @@ class BustubInstance {
   CheckpointManager *checkpoint_manager_;
   Catalog *catalog_;
   ExecutionEngine *execution_engine_;
+
+ private:
+  /** Whether the statements of this session commit synchronously, see `\synchronous_commit`. */
+  bool synchronous_commit_{true};
 };
 
 }  // namespace bustub
@@ -27,18 +27,35 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running page cleaner wakes up every PAGE_CLEANER_INTERVAL, or earlier when a miss had to write back a page. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** A running page dumper writes the resident page ids of the buffer pool every BUFFER_POOL_DUMP_INTERVAL. */
+extern std::chrono::milliseconds buffer_pool_dump_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
+static constexpr int DEFAULT_SEGMENT_ID = 0;                                         // the segment of the db file
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr double PAGE_CLEANER_CLEAN_RATIO = 0.25;  // share of evictable frames the page cleaner keeps clean
+static constexpr uint32_t ASYNC_DISK_QUEUE_DEPTH = 128;  // max page I/Os in flight in an AsyncDiskManager
+static constexpr size_t BUSTUB_INSTANCE_POOL_SIZE = 128;      // frames of the buffer pool of a BustubInstance
+static constexpr size_t BUSTUB_INSTANCE_MAX_POOL_SIZE = 16384;  // frames a BustubInstance's buffer pool can grow to
+
+/** The last BUSTUB_PAGE_TRAILER_SIZE bytes of every page are reserved for its checksum, see DiskManager. */
+static constexpr int BUSTUB_PAGE_TRAILER_SIZE = 4;
+/** The bytes of a page that page layouts can use. */
+static constexpr int BUSTUB_PAGE_DATA_SIZE = BUSTUB_PAGE_SIZE - BUSTUB_PAGE_TRAILER_SIZE;
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
+using segment_id_t = int32_t;  // segment id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
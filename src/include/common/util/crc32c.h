@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes the CRC-32C (Castagnoli) checksum, the one of iSCSI and ext4. On x86-64 CPUs with SSE4.2 it runs on
+ * the crc32 instruction, three streams at a time to hide its latency; elsewhere it falls back to a table-driven
+ * implementation that handles eight bytes per step. Both give the same results.
+ */
+class Crc32c {
+ public:
+  /** @return the CRC-32C of the data */
+  static auto Compute(const char *data, size_t size) -> uint32_t { return Extend(0, data, size); }
+
+  /** @return the CRC-32C of the data that crc was computed over, followed by this data */
+  static auto Extend(uint32_t crc, const char *data, size_t size) -> uint32_t;
+
+  /** @return the CRC-32C of the data, always computed with the tables */
+  static auto ComputeWithTables(const char *data, size_t size) -> uint32_t;
+
+  /** @return true if Compute runs on the crc32 instruction */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
@@ -247,6 +247,16 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return true if the commit of this transaction waits until its COMMIT record is on disk */
+  inline auto IsSynchronousCommit() const -> bool { return synchronous_commit_; }
+
+  /**
+   * Set whether the commit of this transaction waits until its COMMIT record is on disk. Without the wait, a crash
+   * within log_timeout of the commit may lose the transaction, but never leaves it half applied.
+   * @param synchronous_commit false to return from the commit as soon as the COMMIT record is in the log buffer
+   */
+  inline void SetSynchronousCommit(bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+
  private:
   /** The current transaction state. */
   TransactionState state_{TransactionState::GROWING};
@@ -263,6 +273,8 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** Whether the commit waits for the COMMIT record to be on disk. */
+  bool synchronous_commit_{true};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
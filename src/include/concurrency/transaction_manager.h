@@ -39,13 +39,15 @@ class TransactionManager {
    * Begins a new transaction.
    * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
    * @param isolation_level an optional isolation level of the transaction.
+   * @param synchronous_commit false to let the commit of the transaction return before its COMMIT record is on disk
    * @return an initialized transaction
    */
-  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
-      -> Transaction *;
+  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+             bool synchronous_commit = true) -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. With logging enabled, this returns once the COMMIT record of the transaction is on disk,
+   * or, without synchronous commit, once it is in the log buffer.
    * @param txn the transaction to commit
    */
   void Commit(Transaction *txn);
@@ -104,7 +106,7 @@ class TransactionManager {
 
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
@@ -13,9 +13,12 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
-#include <mutex>               // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,16 +28,33 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Appends do not take a latch. The next LSN and the end of the used part of log_buffer_ are packed into one atomic
+ * word, so that a single fetch-add hands out both, and records are in the buffer in LSN order. Each append then
+ * serializes its record into its own part of the buffer, in parallel with the others, and adds its size to the bytes
+ * completed. An append that does not fit anymore seals the buffer: the buffer ends where that append would have
+ * started, and the appends that do not fit wait for the next buffer and get their LSN from it.
+ *
+ * A flush seals the buffer too, and waits until every append that fit has completed before it swaps log_buffer_ and
+ * flush_buffer_. The next buffer opens right after the swap, so appends go on while flush_buffer_ is written out.
+ *
+ * Committing transactions wait in WaitUntilPersistent until their COMMIT record is on disk. They ask the flush thread
+ * for a flush instead of doing one each, so the commits that come in while a flush writes and syncs the log all go out
+ * with the next one: one write and one sync for the whole group.
+ *
+ * The log file is appended to across restarts, so LSNs go on after the last one in it rather than starting at 0 again;
+ * otherwise redo would take the records of a later run for ones the pages of an earlier run have already.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  explicit LogManager(DiskManager *disk_manager) : disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    ContinueLog();
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,29 +66,77 @@ class LogManager {
 
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
-  inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
+  /**
+   * Seal the buffer, wait for the appends that fit in it, swap it out and write it to disk. When it returns, the
+   * records appended before the call are on disk.
+   */
+  void Flush();
+
+  /**
+   * Block until the log record with the given LSN is on disk. With the flush thread running, this asks it for a flush
+   * and waits for it, without the flush thread it flushes right here.
+   */
+  void WaitUntilPersistent(lsn_t lsn);
+
+  /** @return the LSN the next append gets; while the buffer is sealed, a lower bound of it */
+  inline auto GetNextLSN() -> lsn_t {
+    const uint64_t reservation = reservation_.load();
+    return OffsetOf(reservation) <= static_cast<uint32_t>(LOG_BUFFER_SIZE) ? LsnOf(reservation) : LsnOf(sealed_.load());
+  }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Set in sealed_ once the end of the sealed buffer is known. */
+  static constexpr uint64_t SEALED = uint64_t{1} << 63;
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  static auto Pack(lsn_t lsn, uint32_t offset) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(lsn)) << 32) | offset;
+  }
+  static auto LsnOf(uint64_t packed) -> lsn_t { return static_cast<lsn_t>((packed & ~SEALED) >> 32); }
+  static auto OffsetOf(uint64_t packed) -> uint32_t { return static_cast<uint32_t>(packed); }
+
+  /** Read the log on disk to the end, and start the LSNs after the last one in it, which is persistent already. */
+  void ContinueLog();
+
+  /** Serialize a log record, whose LSN is set, into the log buffer at data. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
+
+  /** Tell the flush thread to flush now, or flush right here if there is no flush thread. */
+  void RequestFlush();
+  /** Wait until the sealed buffer was swapped out and appends can go on. */
+  void WaitForOpenBuffer();
+  /** Body of the flush thread. */
+  void RunFlushLoop();
+
+  /** The next LSN in the high half, the end of the reserved part of log_buffer_ in the low half. */
+  std::atomic<uint64_t> reservation_{0};
+  /** Bytes of log_buffer_ whose appends have completed. */
+  std::atomic<uint32_t> completed_{0};
+  /** The next LSN and the end of the sealed buffer, with SEALED set; 0 while the buffer is open. */
+  std::atomic<uint64_t> sealed_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
-  std::atomic<lsn_t> persistent_lsn_;
+  std::atomic<lsn_t> persistent_lsn_{INVALID_LSN};
 
   char *log_buffer_;
   char *flush_buffer_;
 
+  /** Lets one flush run at a time. */
+  std::mutex flush_latch_;
+  /** Guards the flush thread state below, and is held to reopen the buffer. */
   std::mutex latch_;
-
-  std::thread *flush_thread_ __attribute__((__unused__));
-
+  bool flush_thread_running_{false};
+  bool flush_requested_{false};
+  std::unique_ptr<std::thread> flush_thread_;
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Signaled whenever a new buffer opens. */
+  std::condition_variable buffer_open_;
+  /** Signaled whenever a flush has moved the persistent lsn. */
+  std::condition_variable persistent_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
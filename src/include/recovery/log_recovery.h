@@ -13,8 +13,14 @@
 #pragma once
 
 #include <algorithm>
-#include <mutex>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
@@ -24,11 +30,23 @@ namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo runs in parallel. The calling thread reads the log and deserializes the records, and hands each record that
+ * changes a page to the worker that owns the page; the pages are spread over the workers by page id. A worker replays
+ * the records of its pages in LSN order, and skips a record when the page LSN shows that the page has it already, so
+ * replaying the log again changes nothing.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /** Number of redo workers, unless the constructor is told otherwise. */
+  static constexpr size_t DEFAULT_REDO_WORKERS = 4;
+
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager,
+              size_t num_redo_workers = DEFAULT_REDO_WORKERS)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        num_redo_workers_(std::max<size_t>(num_redo_workers, 1)),
+        offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
@@ -39,18 +57,51 @@ class LogRecovery {
 
   void Redo();
   void Undo();
-  auto DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool;
+
+  /**
+   * Deserialize the log record at data.
+   * @param data the serialized record
+   * @param size bytes available at data
+   * @param[out] log_record the record
+   * @return false if the bytes at data do not hold a whole, valid record
+   */
+  auto DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool;
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Records of the pages of one worker, each with the page to replay it on. */
+  using RedoBatch = std::vector<std::pair<page_id_t, LogRecord>>;
+
+  /** Batches a redo worker has not taken yet before the reader waits for it. */
+  static constexpr size_t MAX_PENDING_BATCHES = 8;
+
+  struct RedoWorker {
+    std::mutex latch_;
+    /** Signaled when a batch is handed over or taken, and when the log is read to the end. */
+    std::condition_variable cv_;
+    std::deque<RedoBatch> batches_;
+    bool done_{false};
+    std::thread thread_;
+  };
+
+  /** Body of a redo worker: replay the batches handed to it until the reader is done. */
+  void RunRedoWorker(RedoWorker *worker);
+  /** Hand a batch to the worker, waiting while it has MAX_PENDING_BATCHES already. */
+  static void HandOver(RedoWorker *worker, RedoBatch *batch);
+  /** Replay the part of the record that changes the given page, unless the page has it already. */
+  void RedoLogRecord(page_id_t page_id, LogRecord *log_record);
+  /** Reverse the change of the record on its page. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  const size_t num_redo_workers_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
   std::unordered_map<lsn_t, int> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));  // NOLINT
+  int offset_;
   char *log_buffer_;
 };
 
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager submits page reads and writes to the kernel through io_uring, so that a single thread can keep many
+ * of them in flight. ReadPageAsync and WritePageAsync return as soon as the request is queued; a completion thread
+ * reaps finished requests and makes their futures ready. ReadPage and WritePage submit a request and wait for it.
+ *
+ * At most queue_depth requests are in flight; submitting more blocks until one completes. If the kernel does not
+ * support io_uring, or it is blocked, every request falls back to the synchronous I/O of DiskManager. So do requests
+ * whose buffer is not aligned for direct I/O.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new async disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param queue_depth the maximum number of page I/Os in flight
+   * @param direct_io open the database file with O_DIRECT, if the file system supports it
+   * @param page_checksums write and verify page checksums
+   * @param segment_files let CreateSegment create segment files
+   */
+  explicit AsyncDiskManager(const std::string &db_file, uint32_t queue_depth = ASYNC_DISK_QUEUE_DEPTH,
+                            bool direct_io = false, bool page_checksums = false, bool segment_files = false);
+
+  /** Waits for the I/Os in flight and tears down the ring. */
+  ~AsyncDiskManager() override;
+
+  /** Waits for the I/Os in flight, tears down the ring and closes the files. */
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  /** @return true if requests go through io_uring, false if they fall back to synchronous I/O */
+  auto IsAsync() const -> bool { return ring_ != nullptr; }
+
+ private:
+  /** The mapped io_uring queues. Defined in the .cpp file, so that this header does not pull in the kernel headers. */
+  struct Ring;
+  /** A page I/O that was submitted and has not completed yet. */
+  struct Request;
+
+  /** Queue the request and tell the kernel about it. */
+  auto Submit(std::unique_ptr<Request> request) -> std::future<void>;
+
+  /** Body of the completion thread. */
+  void ReapCompletions();
+
+  /** Finish a request whose completion was reaped, redoing a short or failed read or write synchronously. */
+  void Complete(Request *request, int result);
+
+  /** Wait for the I/Os in flight, stop the completion thread and unmap the ring. */
+  void StopRing();
+
+  /** nullptr if io_uring is not used. */
+  std::unique_ptr<Ring> ring_;
+  uint32_t queue_depth_;
+  /** Serializes submissions and guards in_flight_. */
+  std::mutex submit_latch_;
+  /** Number of requests submitted but not completed yet. */
+  uint32_t in_flight_{0};
+  /** Signaled whenever a request completes, waited on with submit_latch_. */
+  std::condition_variable request_done_;
+  std::unique_ptr<std::thread> completion_thread_;
+};
+
+}  // namespace bustub
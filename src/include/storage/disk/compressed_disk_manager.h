@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager.h
+//
+// Identification: src/include/storage/disk/compressed_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * CompressedDiskManager stores every page compressed with PageCodec, so that scans read fewer bytes from disk. It is a
+ * drop-in DiskManager for the buffer pool: pages go in and come out at BUSTUB_PAGE_SIZE, only the file format differs.
+ * A page that does not compress below BUSTUB_PAGE_SIZE is stored as it is.
+ *
+ * Pages live in variable-size slots, a multiple of SLOT_ALIGNMENT bytes each, anywhere in the file. A page map tells
+ * where the slot of each page is. A page rewritten with about the same size goes back into its slot, otherwise it
+ * moves to a new slot, taken first fit from the free space of the file, or from its end.
+ *
+ * The page map and the FreeSpaceMap are persisted in the file at each SyncPages, a checkpoint: they are written to a
+ * free spot of the file, and then a superblock at offset 0 is pointed at them. Until the checkpoint is durable, the
+ * last checkpoint must stay intact, so a page whose slot it refers to is not rewritten in place, and a slot that was
+ * given up is only reused after the next checkpoint. Page writes and page map changes since the last checkpoint are
+ * lost in a crash; the page writes of DiskManager are not durable before SyncPages either.
+ *
+ * Like DiskManager, it expects that the same page is not read and written at the same time, which the buffer pool
+ * ensures. Direct I/O is not supported, as slots are not aligned to DIRECT_IO_ALIGNMENT. Neither are segment files:
+ * slots already place every page anywhere in the file, so all pages live in the one file, in segment 0.
+ */
+class CompressedDiskManager : public DiskManager {
+ public:
+  /** Slots start at and are sized in multiples of this many bytes. */
+  static constexpr size_t SLOT_ALIGNMENT = 512;
+
+  /**
+   * Creates a new compressed disk manager that writes to the specified database file. An existing file must have
+   * been written by a CompressedDiskManager.
+   * @param db_file the file name of the database file to write to
+   * @param page_checksums write and verify page checksums; they cover the page before compression
+   */
+  explicit CompressedDiskManager(const std::string &db_file, bool page_checksums = false);
+
+  /** Closes the database file if ShutDown was not called, after a last checkpoint. */
+  ~CompressedDiskManager() override;
+
+  /** Makes a last checkpoint and closes the files. */
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Makes the page writes so far durable, and persists the page map and the FreeSpaceMap with them. */
+  void SyncPages() override;
+
+  /** Also gives up the slot of the page. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return the number of pages that are stored in the file */
+  auto GetNumStoredPages() -> size_t;
+
+  /** @return the bytes the stored pages take up in the file, not counting the rounding of their slots */
+  auto GetStoredBytes() -> size_t;
+
+  /** @return the size of the database file */
+  auto GetFileEnd() -> size_t;
+
+ private:
+  /** Where a page is stored. */
+  struct Slot {
+    uint64_t offset_;
+    /** Bytes of page data, BUSTUB_PAGE_SIZE if the page is stored uncompressed. */
+    uint32_t size_;
+    /** True if the page map of a checkpoint refers to the slot, so that it must not be overwritten. */
+    bool checkpointed_;
+  };
+
+  /** @return the bytes a slot takes up in the file for size bytes of data */
+  static auto SlotSize(size_t size) -> size_t { return (size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT; }
+
+  /** Find free space for size bytes, at the end of the file if nothing else fits. Caller must hold latch_. */
+  auto AllocateExtent(size_t size) -> uint64_t;
+  /** Return the space of an extent, merging it with its free neighbours. Caller must hold latch_. */
+  void FreeExtent(uint64_t offset, size_t size);
+  /** Give up a slot: right away if no checkpoint refers to it, or after the next one. Caller must hold latch_. */
+  void ReleaseSlot(const Slot &slot);
+
+  /** Write size bytes at the offset of the file. */
+  void WriteBytes(uint64_t offset, const char *data, size_t size);
+  /** Read size bytes at the offset of the file. @return false on an I/O error or a short read */
+  auto ReadBytes(uint64_t offset, char *data, size_t size) -> bool;
+
+  /** Read the checkpoint the superblock points at, and rebuild the free space of the file around its slots. */
+  void LoadCheckpoint();
+  /** Persist the page map and the FreeSpaceMap, see the class comment. */
+  void Checkpoint();
+
+  /** File descriptor of the database file, -1 once it is closed. */
+  int fd_{-1};
+
+  /** Held shared by page writes, and exclusively by a checkpoint while it takes its snapshot of the page map. */
+  std::shared_mutex write_latch_;
+  /** Lets one checkpoint run at a time. */
+  std::mutex checkpoint_latch_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::unordered_map<page_id_t, Slot> slots_;
+  /** Free space of the file by offset, merged with their neighbours. */
+  std::map<uint64_t, uint64_t> free_extents_;
+  /** Extents that become free once the next checkpoint is durable. */
+  std::vector<std::pair<uint64_t, uint64_t>> pending_free_;
+  /** The extent of the last checkpoint. */
+  std::pair<uint64_t, uint64_t> checkpoint_extent_{0, 0};
+  /** End of the used part of the file. */
+  uint64_t file_end_{SLOT_ALIGNMENT};
+  /** Sum of the sizes of slots_. */
+  size_t stored_bytes_{0};
+};
+
+}  // namespace bustub
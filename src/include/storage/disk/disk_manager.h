@@ -13,53 +13,208 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/free_space_map.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread/pwrite on a file descriptor, so page I/O from different threads runs in
+ * parallel without a latch. Page writes go to the OS page cache; SyncPages makes them durable.
+ *
+ * DiskManager also allocates page ids. A FreeSpaceMap tracks which page ids are in use, so that deleted pages are
+ * reused instead of growing the file forever. Its map pages are stored in the database file itself, each one in front
+ * of the PAGES_PER_MAP_PAGE pages it covers: the file starts with map page 0, followed by pages
+ * [0, PAGES_PER_MAP_PAGE), then map page 1, and so on. Changes to the map are written through right away.
+ *
+ * With direct I/O the database file is opened with O_DIRECT and page I/O bypasses the OS page cache, so pages are not
+ * cached twice, once in the buffer pool and once by the OS. O_DIRECT needs page buffers aligned to
+ * DIRECT_IO_ALIGNMENT, which buffer pool frames are; pages in unaligned buffers go through an aligned bounce buffer.
+ *
+ * With page checksums, every page is written with a CRC-32C of its first BUSTUB_PAGE_DATA_SIZE bytes in its trailer,
+ * the last BUSTUB_PAGE_TRAILER_SIZE bytes, which page layouts leave alone. The checksum is computed over a private copy
+ * of the page, and the copy is written, so a page that changes in the buffer pool while it is written still goes to
+ * disk consistent. Every page read is checked against its checksum, which catches torn writes and corrupted sectors
+ * without scanning the data structures; a mismatch is logged and counted, see GetNumChecksumFailures. A page that was
+ * never written reads as zeros and passes.
+ *
+ * With segment files, every table and index can get a segment of its own, see CreateSegment. A segment is a file next
+ * to the db file, with the same layout and a FreeSpaceMap of its own; the db file itself is segment 0. The segment of
+ * a page is in the high bits of its page id, so the buffer pool and the page layouts need not know about segments.
+ * Without segment files, page ids are not split and the db file holds the whole page_id_t range.
+ * Pages allocated near a page of a segment stay in its file, so the pages of a table are not interleaved with those
+ * of other tables, its scans read its file front to back, and dropping it deletes the file as a whole. Every file
+ * grows by EXTENT_PAGES pages at a time, which the file system can lay out contiguously.
  */
 class DiskManager {
  public:
+  /** Alignment of the buffers, file offsets and sizes of O_DIRECT I/O. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+  /**
+   * With segment files, a page id holds the index of the page in its segment in its low SEGMENT_PAGE_BITS bits, the
+   * segment above.
+   */
+  static constexpr int SEGMENT_PAGE_BITS = 20;
+  /** Number of pages a segment can hold. */
+  static constexpr page_id_t PAGES_PER_SEGMENT = page_id_t{1} << SEGMENT_PAGE_BITS;
+  /** Number of segment ids, segment 0 included. */
+  static constexpr segment_id_t MAX_SEGMENTS = segment_id_t{1} << (31 - SEGMENT_PAGE_BITS);
+  /** The files are preallocated this many pages at a time. */
+  static constexpr size_t EXTENT_PAGES = 32;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, if the file system supports it
+   * @param page_checksums write and verify page checksums
+   * @param segment_files split page ids into segments, open the segment files next to the db file and let
+   * CreateSegment create new ones
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false, bool page_checksums = false,
+                       bool segment_files = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
-  DiskManager() = default;
+  DiskManager();
 
-  virtual ~DiskManager() = default;
+  /** Closes the database file if ShutDown was not called. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. The write is not synced, see SyncPages.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. A page past the end of the file reads as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Write a batch of pages, e.g. all the dirty pages of a buffer pool. The pages are written in page id order, and
+   * runs of consecutive page ids go to disk with a single vectored write. A page on its own is written with
+   * WritePageAsync, so an asynchronous disk manager keeps those writes in flight together. Returns once every page is
+   * written; like WritePage, the writes are not synced.
+   * @param pages the page id and raw page data of each page
+   */
+  virtual void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
+
+  /**
+   * Read a batch of pages, e.g. the pages a buffer pool prefetches. The counterpart of WritePages: the pages are read
+   * in page id order, runs of consecutive page ids with a single vectored read, and a page on its own with
+   * ReadPageAsync. Returns once every page is read; pages past the end of the file read as zeros.
+   * @param pages the page id and output buffer of each page
+   */
+  virtual void ReadPages(std::vector<std::pair<page_id_t, char *>> pages);
+
+  /**
+   * Make all page writes so far durable. Called whenever durability requires it, e.g. when the buffer pool flushes
+   * all of its pages; individual writes are never synced.
+   */
+  virtual void SyncPages();
+
+  /**
+   * Allocate a page id in the database file, reusing the id of a deallocated page if there is one. The page goes into
+   * the segment of near_page_id, segment 0 without one.
+   * @param near_page_id the page the new page should follow on disk, e.g. the last page of the same table, or
+   * INVALID_PAGE_ID; see FreeSpaceMap::Allocate
+   * @param num_instances number of buffer pool instances sharing the page id space
+   * @param instance_index the instance that allocates, the page id is instance_index modulo num_instances
+   * @return the allocated page id
+   */
+  auto AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID, uint32_t num_instances = 1, uint32_t instance_index = 0)
+      -> page_id_t;
+
+  /**
+   * Free a page id so that it can be allocated again. Does nothing if the page is not allocated.
+   * @param page_id id of the page
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Mark a page id allocated, and write its map page through, if it is not allocated already. Redo calls this for
+   * every page the log says was created, since the map page of an allocation may not have made it to disk.
+   * @param page_id id of the page
+   */
+  void MarkPageAllocated(page_id_t page_id);
+
+  /** @return the number of allocated pages */
+  auto GetNumAllocatedPages() -> size_t;
+
+  /** @return true if the page id is allocated, i.e. it was handed out by AllocatePage and not deallocated since */
+  auto IsPageAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * Create a new segment with a file of its own. Its first page, SegmentHeaderPageId, is allocated right away, so that
+   * the segment is never empty and the first page of the structure that owns it can be allocated near it.
+   * @return the id of the new segment, or DEFAULT_SEGMENT_ID if segment files are off, in which case callers simply
+   * allocate in the db file
+   */
+  virtual auto CreateSegment() -> segment_id_t;
+
+  /**
+   * Delete a segment and its file, with all of its pages. Its pages must not be read or written anymore, and must not
+   * be in flight; the buffer pool makes sure of that, see BufferPoolManager::DeleteSegment.
+   * @param segment id of the segment
+   * @return false if there is no such segment, or it is segment 0, which cannot be deleted
+   */
+  auto DeleteSegment(segment_id_t segment) -> bool;
+
+  /** @return true if the segment exists */
+  auto HasSegment(segment_id_t segment) -> bool;
+
+  /** @return the name of the file of a segment other than segment 0 */
+  auto GetSegmentFileName(segment_id_t segment) const -> std::string {
+    return file_name_ + "." + std::to_string(segment);
+  }
+
+  /** @return the segment of a page, if segment files are on; without them every page is in segment 0 */
+  static auto SegmentOf(page_id_t page_id) -> segment_id_t { return page_id >> SEGMENT_PAGE_BITS; }
+
+  /** @return the first page of a segment, which CreateSegment allocates; HEADER_PAGE_ID for segment 0 */
+  static auto SegmentHeaderPageId(segment_id_t segment) -> page_id_t { return segment << SEGMENT_PAGE_BITS; }
+
+  /**
+   * Start reading a page from the database file. The buffer must stay valid until the returned future is ready.
+   * DiskManager reads the page right away and returns a ready future; AsyncDiskManager keeps many reads in flight.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return a future that becomes ready once the page is in page_data
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Start writing a page to the database file. The buffer must stay valid and unchanged until the returned future is
+   * ready. DiskManager writes the page right away and returns a ready future.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that becomes ready once the write is done
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Flush the entire log buffer into disk, and sync the log file.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -83,6 +238,24 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return true if page I/O bypasses the OS page cache */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+  /** @return the number of times the database file was synced */
+  auto GetNumSyncs() const -> int { return num_syncs_; }
+
+  /** @return true if pages are written with a checksum, and checked against it when they are read */
+  auto HasPageChecksums() const -> bool { return page_checksums_; }
+
+  /** @return the number of pages read whose checksum did not match */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /** Store the checksum of a page in its trailer. */
+  static void SetPageChecksum(char *page_data);
+
+  /** @return true if the trailer of a page holds its checksum, or if the page is all zeros, i.e. was never written */
+  static auto IsPageChecksumValid(const char *page_data) -> bool;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,19 +266,94 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /** A file of the database, which holds the pages of one segment. */
+  struct SegmentFile {
+    // file descriptor, -1 if the disk manager keeps its pages elsewhere
+    int fd_{-1};
+    // size of the file, kept up to date by the writes so that reads do not have to stat the file
+    std::atomic<size_t> size_{0};
+    // end of the space preallocated for the file, guarded by free_space_latch_
+    size_t reserved_{0};
+    // tracks the allocated pages of the segment by their index in it, guarded by free_space_latch_
+    FreeSpaceMap free_space_map_;
+  };
+
+  /** Open the log file next to file_name_, creating it if needed. @return false if file_name_ has no extension */
+  auto OpenLog() -> bool;
   auto GetFileSize(const std::string &file_name) -> int;
+  /**
+   * Open the file of a segment, with O_DIRECT if direct_io_, and load its FreeSpaceMap.
+   * @param open_flags flags for open besides O_RDWR, e.g. O_CREAT
+   * @return nullptr if the file cannot be opened
+   */
+  auto OpenSegmentFile(const std::string &file_name, int open_flags) -> std::unique_ptr<SegmentFile>;
+  /** Open the segment files next to the db file. */
+  void OpenSegmentFiles();
+  /** @return the file of the segment the page is in, nullptr if there is no such segment */
+  auto FileOf(page_id_t page_id) -> SegmentFile * {
+    const segment_id_t segment = segment_files_ ? SegmentOf(page_id) : DEFAULT_SEGMENT_ID;
+    return segment >= 0 && segment < MAX_SEGMENTS ? segments_[segment].get() : nullptr;
+  }
+  /** @return the index of the page in the file of its segment, the page id itself without segment files */
+  auto IndexOf(page_id_t page_id) const -> page_id_t {
+    return segment_files_ ? page_id & (PAGES_PER_SEGMENT - 1) : page_id;
+  }
+  /** @return the file of segment 0, the db file */
+  auto DbFile() -> SegmentFile & { return *segments_[DEFAULT_SEGMENT_ID]; }
+  /** Remember that the file is now at least end bytes long. */
+  static void GrowFileSize(SegmentFile *file, size_t end);
+  /** @return the offset of the page in the file of its segment, which skips the map pages in front of it */
+  auto PageOffset(page_id_t page_id) const -> size_t { return IndexOffset(IndexOf(page_id)); }
+  /** @return the offset of the page at the index in the file of its segment */
+  static auto IndexOffset(page_id_t index) -> size_t {
+    return (static_cast<size_t>(index) + FreeSpaceMap::MapPageOf(index) + 1) * BUSTUB_PAGE_SIZE;
+  }
+  /** @return the offset of a map page of the FreeSpaceMap in the file */
+  static auto MapPageOffset(size_t map_page) -> size_t {
+    return map_page * (FreeSpaceMap::PAGES_PER_MAP_PAGE + 1) * BUSTUB_PAGE_SIZE;
+  }
+  /** Write BUSTUB_PAGE_SIZE bytes at the offset of the file. */
+  void WriteAt(SegmentFile *file, size_t offset, const char *data);
+  /** Write num_pages pages of BUSTUB_PAGE_SIZE bytes, back to back from the offset of the file, with pwritev. */
+  void WriteRunAt(SegmentFile *file, size_t offset, const char *const *pages_data, size_t num_pages);
+  /** Read BUSTUB_PAGE_SIZE bytes at the offset of the file, zero-filling whatever lies past the end of the file. */
+  void ReadAt(SegmentFile *file, size_t offset, char *data);
+  /** Read num_pages pages back to back from the offset of the file with preadv, zero-filling past the end. */
+  void ReadRunAt(SegmentFile *file, size_t offset, char *const *pages_data, size_t num_pages);
+  /** Write a map page of the FreeSpaceMap of the file through to it. Caller must hold free_space_latch_. */
+  void StoreMapPage(SegmentFile *file, size_t map_page);
+  /** Preallocate whole extents of the file up to the page at index. Caller must hold free_space_latch_. */
+  static void ReserveExtents(SegmentFile *file, page_id_t index);
+  /** Check a page that was read against its checksum if page checksums are on, and report a mismatch. */
+  void VerifyPageChecksum(page_id_t page_id, const char *page_data);
+  /** @return true if the buffer cannot take direct I/O as it is and must go through a bounce buffer */
+  auto NeedsBounceBuffer(const char *page_data) const -> bool {
+    return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0;
+  }
   // stream to write log file
   std::fstream log_io_;
+  // descriptor of the log file to sync it with, -1 if it is not open
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // true if the files were opened with O_DIRECT
+  bool direct_io_{false};
+  // true if pages carry a checksum in their trailer
+  bool page_checksums_{false};
+  // true if page ids are split into segments with a file each
+  bool segment_files_{false};
+  std::atomic<int> num_checksum_failures_{0};
   std::string file_name_;
+  // the files of the segments by segment id, nullptr where there is no segment; segment 0 is the db file and always
+  // there. An entry only changes while no page of its segment is read or written.
+  std::vector<std::unique_ptr<SegmentFile>> segments_;
+  // serializes creating and deleting segments and the walks over all of them
+  std::mutex segments_latch_;
+  std::mutex free_space_latch_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
@@ -9,24 +9,88 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
+/**
+ * The service times of a simulated device. An operation moves one page, or a run of consecutive pages: it waits for
+ * a free slot of the device queue, then pays the access latency, plus the seek latency unless it starts right where
+ * the previous operation ended, then transfers its bytes at the bandwidth of the device. Transfers do not overlap;
+ * latencies do, up to queue_depth_ operations at a time. A zero means free, or unlimited for queue_depth_.
+ */
+struct DiskLatencyModel {
+  std::chrono::nanoseconds read_latency_{0};
+  std::chrono::nanoseconds write_latency_{0};
+  std::chrono::nanoseconds seek_latency_{0};
+  std::chrono::nanoseconds sync_latency_{0};
+  /** Bytes per second. */
+  uint64_t read_bandwidth_{0};
+  uint64_t write_bandwidth_{0};
+  /** Number of operations the device serves at a time. */
+  uint32_t queue_depth_{0};
+
+  /** @return a model where every operation is free, i.e. plain memcpy */
+  static auto None() -> DiskLatencyModel { return {}; }
+
+  /** @return a model of a datacenter NVMe SSD */
+  static auto Nvme() -> DiskLatencyModel {
+    using std::chrono::microseconds;
+    return {microseconds(80), microseconds(20), microseconds(0), microseconds(30), 3000000000, 2000000000, 64};
+  }
+
+  /** @return a model of a 7200 rpm hard disk, where every random access pays a seek and a half rotation */
+  static auto Hdd() -> DiskLatencyModel {
+    using std::chrono::microseconds;
+    return {microseconds(100), microseconds(100), microseconds(8000), microseconds(10000), 200000000, 200000000, 1};
+  }
+
+  /** @return true if every operation is free */
+  auto IsNone() const -> bool {
+    return read_latency_.count() == 0 && write_latency_.count() == 0 && seek_latency_.count() == 0 &&
+           sync_latency_.count() == 0 && read_bandwidth_ == 0 && write_bandwidth_ == 0;
+  }
+};
+
 /**
  * DiskManagerMemory replicates the utility of DiskManager on memory. It is primarily used for
  * data structure performance testing.
+ *
+ * Pages are kept in chunks of CHUNK_PAGES pages, allocated the first time one of their pages is written, so the page
+ * ids in use may be sparse and grow without bound; a page that was never written reads as zeros. Every operation is
+ * delayed as DiskLatencyModel says, so that a benchmark sees the I/O costs of a real device, and overlapping I/O pays
+ * off as it would on one: ReadPageAsync and WritePageAsync return at once with a future that becomes ready when the
+ * simulated device finishes, and ReadPages and WritePages move runs of consecutive pages as one operation.
  */
 class DiskManagerMemory : public DiskManager {
  public:
-  explicit DiskManagerMemory(size_t pages);
+  /** Pages per chunk of memory. */
+  static constexpr size_t CHUNK_PAGES = 64;
 
-  ~DiskManagerMemory() override { delete[] memory_; }
+  /**
+   * @param pages the number of pages expected to be stored, which sizes the chunk directory up front; more can be
+   * stored
+   * @param model the service times of the simulated device
+   */
+  explicit DiskManagerMemory(size_t pages = 0, const DiskLatencyModel &model = DiskLatencyModel::None());
+
+  ~DiskManagerMemory() override = default;
 
   /**
    * Write a page to the database file.
@@ -42,8 +106,95 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /** Each run of consecutive pages is one write of the device. */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  /** Each run of consecutive pages is one read of the device. */
+  void ReadPages(std::vector<std::pair<page_id_t, char *>> pages) override;
+
+  /** Waits for the operations in flight, and then for the sync latency. */
+  void SyncPages() override;
+
+  /** The page is read right away; the future becomes ready when the simulated read is done. */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  /** The page is written right away; the future becomes ready when the simulated write is done. */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  /** @return the service times of the simulated device */
+  auto GetLatencyModel() const -> const DiskLatencyModel & { return model_; }
+
+  /** @return the number of pages read */
+  auto GetNumReads() const -> uint64_t { return num_reads_; }
+
+  /** @return the number of read and write operations of the device, a run of pages counting once */
+  auto GetNumOperations() const -> uint64_t { return num_operations_; }
+
+  /** @return the bytes read */
+  auto GetBytesRead() const -> uint64_t { return bytes_read_; }
+
+  /** @return the bytes written */
+  auto GetBytesWritten() const -> uint64_t { return bytes_written_; }
+
+  /** @return the number of operations that did not go on where the previous one ended; 0 without a latency model */
+  auto GetNumSeeks() const -> uint64_t { return num_seeks_; }
+
+  /** @return the time operations spent waiting for a free slot of the device queue; 0 without a latency model */
+  auto GetQueueWaitTime() const -> std::chrono::nanoseconds { return std::chrono::nanoseconds(queue_wait_nanos_); }
+
+  /** @return the time from the start to the end of every operation, summed up; 0 without a latency model */
+  auto GetServiceTime() const -> std::chrono::nanoseconds { return std::chrono::nanoseconds(service_nanos_); }
+
+  /** @return the number of chunks of memory allocated to hold pages */
+  auto GetNumChunks() -> size_t;
+
  private:
-  char *memory_;
+  using Clock = std::chrono::steady_clock;
+
+  /** @return the memory of a page, nullptr if its chunk does not exist and create is false */
+  auto PageMemory(page_id_t page_id, bool create) -> char *;
+  /** Copy a page out of memory, or zeros if it was never written. */
+  void CopyOut(page_id_t page_id, char *page_data);
+
+  /**
+   * Account for an operation of the simulated device and work out when it is done.
+   * @param page_id the first page of the operation
+   * @param num_pages the number of consecutive pages it moves
+   * @param write true for a write, false for a read
+   * @return the time the operation is done
+   */
+  auto Schedule(page_id_t page_id, size_t num_pages, bool write) -> Clock::time_point;
+
+  /** Wait until the time, sleeping most of the way and spinning the rest, so that short latencies stay accurate. */
+  static void WaitUntil(Clock::time_point done);
+
+  /** @return a future that is ready at the time done; the thread that gets it does the waiting */
+  static auto FutureAt(Clock::time_point done) -> std::future<void>;
+
+  const DiskLatencyModel model_;
+
+  /** Guards chunks_; held shared to look a chunk up, and exclusively to add one. */
+  std::shared_mutex chunks_latch_;
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> chunks_;
+
+  /** Guards the state of the simulated device below. */
+  std::mutex device_latch_;
+  /** When each slot of the device queue becomes free; one slot per operation in service. */
+  std::vector<Clock::time_point> slots_;
+  /** When the transfer of the last operation ends. */
+  Clock::time_point transfer_end_;
+  /** When the last operation to finish is done. */
+  Clock::time_point last_done_;
+  /** The page right after the last operation, which the next one can go on with without a seek. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+
+  std::atomic<uint64_t> num_reads_{0};
+  std::atomic<uint64_t> num_operations_{0};
+  std::atomic<uint64_t> bytes_read_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  std::atomic<uint64_t> num_seeks_{0};
+  std::atomic<int64_t> queue_wait_nanos_{0};
+  std::atomic<int64_t> service_nanos_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap is a bitmap with one bit per page id that tells whether the page is allocated. Allocation hands out the
+ * lowest free page id, so the ids of deleted pages are reused before the database file grows.
+ *
+ * On disk the bitmap is split into map pages of BUSTUB_PAGE_SIZE bytes, each covering PAGES_PER_MAP_PAGE consecutive
+ * page ids; see DiskManager for where they live in the database file. LoadMapPage and StoreMapPage convert between a
+ * map page and the in-memory bitmap.
+ *
+ * Not thread-safe, DiskManager serializes access.
+ */
+class FreeSpaceMap {
+ public:
+  /** Number of page ids covered by one map page. */
+  static constexpr page_id_t PAGES_PER_MAP_PAGE = BUSTUB_PAGE_SIZE * 8;
+
+  /**
+   * Allocate a free page id. A buffer pool that is one of several instances of a parallel buffer pool only owns the
+   * page ids that are instance_index modulo num_instances, so only those are considered.
+   *
+   * With a near_page_id, the first free id after it is preferred as long as it does not grow the map, so that pages
+   * allocated one after another for the same table stay contiguous on disk. Otherwise, and if there is no such id,
+   * the lowest free id is taken.
+   *
+   * @param near_page_id the page the new page should follow, INVALID_PAGE_ID if it does not matter
+   * @param num_instances number of buffer pool instances sharing the page id space
+   * @param instance_index the instance that allocates
+   * @return the allocated page id
+   */
+  auto Allocate(page_id_t near_page_id = INVALID_PAGE_ID, uint32_t num_instances = 1, uint32_t instance_index = 0)
+      -> page_id_t;
+
+  /**
+   * Give a page id back.
+   * @return false if the page was not allocated
+   */
+  auto Deallocate(page_id_t page_id) -> bool;
+
+  /**
+   * Take a given page id, e.g. one that recovery finds in use.
+   * @return false if the page was allocated already
+   */
+  auto MarkAllocated(page_id_t page_id) -> bool;
+
+  /** @return true if the page id is allocated */
+  auto IsAllocated(page_id_t page_id) const -> bool;
+
+  /** @return the number of allocated page ids */
+  auto GetNumAllocated() const -> size_t { return num_allocated_; }
+
+  /** @return one past the highest page id that was ever allocated, i.e. the number of page ids in use or freed */
+  auto GetEnd() const -> page_id_t { return end_; }
+
+  /** @return the map page that covers the page id */
+  static auto MapPageOf(page_id_t page_id) -> size_t { return static_cast<size_t>(page_id / PAGES_PER_MAP_PAGE); }
+
+  /** @return the number of map pages needed to cover every page id below GetEnd() */
+  auto GetNumMapPages() const -> size_t {
+    return (static_cast<size_t>(end_) + PAGES_PER_MAP_PAGE - 1) / PAGES_PER_MAP_PAGE;
+  }
+
+  /**
+   * Replace the part of the bitmap covered by a map page with the map page read from disk.
+   * @param map_page index of the map page
+   * @param data BUSTUB_PAGE_SIZE bytes of map page
+   */
+  void LoadMapPage(size_t map_page, const char *data);
+
+  /**
+   * Write out the part of the bitmap covered by a map page.
+   * @param map_page index of the map page
+   * @param[out] data BUSTUB_PAGE_SIZE bytes of map page
+   */
+  void StoreMapPage(size_t map_page, char *data) const;
+
+ private:
+  static constexpr size_t WORDS_PER_MAP_PAGE = BUSTUB_PAGE_SIZE / sizeof(uint64_t);
+
+  /** @return the lowest page id at or after from that belongs to the instance */
+  static auto AlignUp(page_id_t from, uint32_t num_instances, uint32_t instance_index) -> page_id_t;
+
+  /** @return the lowest free page id of the instance in [from, end_), INVALID_PAGE_ID if there is none */
+  auto FindFree(page_id_t from, uint32_t num_instances) const -> page_id_t;
+
+  void Set(page_id_t page_id);
+
+  /** One bit per page id, set if the page is allocated. Grows a whole map page at a time. */
+  std::vector<uint64_t> bits_;
+  size_t num_allocated_{0};
+  page_id_t end_{0};
+  /**
+   * Per instance, a page id below which every page id of the instance is allocated, so that allocation does not scan
+   * the allocated prefix of the map over and over. Reset when the number of instances changes.
+   */
+  std::vector<page_id_t> cursors_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/storage/disk/page_codec.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * PageCodec is a small LZ77 compressor for page images, in the block format of LZ4: a sequence of tokens, each
+ * followed by a run of literal bytes and a back reference of at least MIN_MATCH bytes into the output produced so
+ * far. A reference may overlap the bytes it produces, so a run of equal bytes, e.g. the zeros of a half empty page or
+ * of fixed-width integer columns, costs a few bytes. Compression makes a single greedy pass with a hash table of
+ * recent positions; decompression checks every length and offset, so a corrupt input fails instead of overrunning the
+ * buffers.
+ *
+ * Stateless and thread-safe.
+ */
+class PageCodec {
+ public:
+  /** Shortest back reference. */
+  static constexpr size_t MIN_MATCH = 4;
+
+  /** @return the largest size Compress can produce for an input of the given size */
+  static constexpr auto MaxCompressedSize(size_t size) -> size_t { return size + size / 255 + 16; }
+
+  /**
+   * Compress a buffer.
+   * @param src the data to compress
+   * @param size the size of the data
+   * @param[out] dst receives the compressed data, must hold MaxCompressedSize(size) bytes
+   * @return the size of the compressed data
+   */
+  static auto Compress(const char *src, size_t size, char *dst) -> size_t;
+
+  /**
+   * Decompress a buffer produced by Compress.
+   * @param src the compressed data
+   * @param size the size of the compressed data
+   * @param[out] dst receives the decompressed data
+   * @param dst_size the size of the data before compression
+   * @return false if the compressed data is corrupt or does not decompress to exactly dst_size bytes
+   */
+  static auto Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace bustub
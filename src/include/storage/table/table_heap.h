@@ -95,9 +95,10 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param access_type why the tuple is read, passed on to the buffer pool
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type = AccessType::Lookup) -> bool;
 
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
@@ -108,6 +109,14 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * Delete the table with all of its pages. A table in a segment of its own is deleted with the file of the segment;
+   * the pages of a table in the db file are deleted one by one. The table must not be used while it is dropped, and
+   * is empty afterwards.
+   * @return false if a page of the table is pinned, in which case it may be dropped in part
+   */
+  auto Drop() -> bool;
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
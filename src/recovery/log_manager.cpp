@@ -12,6 +12,11 @@
 
 #include "recovery/log_manager.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +27,212 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_running_) {
+    return;
+  }
+  flush_thread_running_ = true;
+  enable_logging = true;
+  flush_thread_ = std::make_unique<std::thread>(&LogManager::RunFlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!flush_thread_running_) {
+      return;
+    }
+    flush_thread_running_ = false;
+  }
+  cv_.notify_one();
+  // The flush thread writes out what is left before it exits.
+  flush_thread_->join();
+  flush_thread_.reset();
+  enable_logging = false;
+}
+
+void LogManager::RunFlushLoop() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, log_timeout, [this] { return !flush_thread_running_ || flush_requested_; });
+    const bool stop = !flush_thread_running_;
+    flush_requested_ = false;
+    lock.unlock();
+    Flush();
+    lock.lock();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void LogManager::ContinueLog() {
+  // Only the headers are looked at: the size to get to the next record, and the LSN. Past the end of the log there
+  // are zeros, which are no record.
+  lsn_t last_lsn = INVALID_LSN;
+  int offset = 0;
+  while (disk_manager_->ReadLog(flush_buffer_, LOG_BUFFER_SIZE, offset)) {
+    size_t pos = 0;
+    while (pos + LogRecord::HEADER_SIZE <= static_cast<size_t>(LOG_BUFFER_SIZE)) {
+      int32_t size;
+      lsn_t lsn;
+      int32_t log_record_type;
+      memcpy(&size, flush_buffer_ + pos, sizeof(int32_t));
+      memcpy(&lsn, flush_buffer_ + pos + 4, sizeof(lsn_t));
+      memcpy(&log_record_type, flush_buffer_ + pos + 16, sizeof(int32_t));
+      if (size < LogRecord::HEADER_SIZE || pos + size > static_cast<size_t>(LOG_BUFFER_SIZE) ||
+          log_record_type <= static_cast<int32_t>(LogRecordType::INVALID) ||
+          log_record_type > static_cast<int32_t>(LogRecordType::NEWPAGE)) {
+        break;
+      }
+      last_lsn = std::max(last_lsn, lsn);
+      pos += size;
+    }
+    // A record is never larger than the buffer, so if not even one record is in it, the log ends here.
+    if (pos == 0) {
+      break;
+    }
+    offset += static_cast<int>(pos);
+  }
+  reservation_ = Pack(last_lsn + 1, 0);
+  persistent_lsn_ = last_lsn;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  const auto size = static_cast<uint32_t>(log_record->size_);
+  BUSTUB_ASSERT(size <= static_cast<uint32_t>(LOG_BUFFER_SIZE), "log record larger than the log buffer");
+  while (true) {
+    // One fetch-add takes the LSN and the space together.
+    const uint64_t reservation = reservation_.fetch_add(Pack(1, size));
+    const uint32_t offset = OffsetOf(reservation);
+    if (offset + size <= static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+      log_record->lsn_ = LsnOf(reservation);
+      SerializeLogRecord(*log_record, log_buffer_ + offset);
+      completed_ += size;
+      return log_record->lsn_;
+    }
+    // The first append that does not fit seals the buffer where it would have started. Its LSN is the first one of the
+    // next buffer, the LSNs of the appends that do not fit are handed out again there.
+    if (offset <= static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+      sealed_ = SEALED | Pack(LsnOf(reservation), offset);
+      RequestFlush();
+    }
+    WaitForOpenBuffer();
+  }
+}
+
+void LogManager::RequestFlush() {
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      return;
+    }
+  }
+  Flush();
+}
+
+void LogManager::WaitForOpenBuffer() {
+  std::unique_lock lock(latch_);
+  buffer_open_.wait(lock, [this] { return OffsetOf(reservation_) <= static_cast<uint32_t>(LOG_BUFFER_SIZE); });
+}
+
+void LogManager::Flush() {
+  std::scoped_lock flush_lock(flush_latch_);
+  // Seal the buffer, unless an append that did not fit did so already; then wait until it says where the buffer ends.
+  const uint64_t reservation = reservation_.fetch_add(LOG_BUFFER_SIZE + 1);
+  uint64_t sealed = SEALED | reservation;
+  if (OffsetOf(reservation) > static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+    while ((sealed = sealed_) == 0) {
+      std::this_thread::yield();
+    }
+  }
+  const uint32_t end = OffsetOf(sealed);
+  const lsn_t next_lsn = LsnOf(sealed);
+  while (completed_ != end) {
+    std::this_thread::yield();
+  }
+
+  std::swap(log_buffer_, flush_buffer_);
+  completed_ = 0;
+  sealed_ = 0;
+  {
+    std::scoped_lock lock(latch_);
+    reservation_ = Pack(next_lsn, 0);
+  }
+  buffer_open_.notify_all();
+
+  // WriteLog also takes an empty buffer, it expects the two buffers to take turns.
+  disk_manager_->WriteLog(flush_buffer_, static_cast<int>(end));
+  {
+    std::scoped_lock lock(latch_);
+    persistent_lsn_ = next_lsn - 1;
+  }
+  persistent_.notify_all();
+}
+
+void LogManager::WaitUntilPersistent(lsn_t lsn) {
+  while (persistent_lsn_ < lsn) {
+    {
+      std::unique_lock lock(latch_);
+      if (flush_thread_running_) {
+        flush_requested_ = true;
+        cv_.notify_one();
+        persistent_.wait(lock, [this, lsn] { return persistent_lsn_ >= lsn || !flush_thread_running_; });
+        continue;
+      }
+    }
+    Flush();
+  }
+}
+
+/*
+ * Serialize the header of the record, then its body:
+ * | size | LSN | transID | prevLSN | LogType | body |
+ */
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *data) {
+  const auto log_record_type = static_cast<int32_t>(log_record.log_record_type_);
+  memcpy(data, &log_record.size_, sizeof(int32_t));
+  memcpy(data + 4, &log_record.lsn_, sizeof(lsn_t));
+  memcpy(data + 8, &log_record.txn_id_, sizeof(txn_id_t));
+  memcpy(data + 12, &log_record.prev_lsn_, sizeof(lsn_t));
+  memcpy(data + 16, &log_record_type, sizeof(int32_t));
+  char *pos = data + LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
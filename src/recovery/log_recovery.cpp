@@ -12,15 +12,95 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <functional>
+
+#include "common/macros.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
+
+namespace {
+
+/** Read a value of type T at *pos if it ends before end, and move *pos past it. */
+template <typename T>
+auto DeserializeValue(const char **pos, const char *end, T *value) -> bool {
+  if (end - *pos < static_cast<std::ptrdiff_t>(sizeof(T))) {
+    return false;
+  }
+  memcpy(value, *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+
+/** Read a tuple serialized by Tuple::SerializeTo at *pos if it ends before end, and move *pos past it. */
+auto DeserializeTuple(const char **pos, const char *end, Tuple *tuple) -> bool {
+  int32_t size;
+  if (!DeserializeValue(pos, end, &size) || size < 0 || end - *pos < size) {
+    return false;
+  }
+  tuple->DeserializeFrom(*pos - sizeof(int32_t));
+  *pos += size;
+  return true;
+}
+
+}  // namespace
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool { return false; }
+auto LogRecovery::DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool {
+  // The header says how long the record is, so the record is complete or not before its body is looked at. Past the
+  // end of the log there are zeros, which are no record either.
+  int32_t record_size;
+  int32_t log_record_type;
+  if (size < static_cast<size_t>(LogRecord::HEADER_SIZE)) {
+    return false;
+  }
+  memcpy(&record_size, data, sizeof(int32_t));
+  memcpy(&log_record_type, data + 16, sizeof(int32_t));
+  if (record_size < LogRecord::HEADER_SIZE || static_cast<size_t>(record_size) > size ||
+      log_record_type <= static_cast<int32_t>(LogRecordType::INVALID) ||
+      log_record_type > static_cast<int32_t>(LogRecordType::NEWPAGE)) {
+    return false;
+  }
+
+  *log_record = LogRecord();
+  log_record->size_ = record_size;
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  log_record->log_record_type_ = static_cast<LogRecordType>(log_record_type);
+
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  const char *end = data + record_size;
+  bool ok = true;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      ok = DeserializeValue(&pos, end, &log_record->insert_rid_) &&
+           DeserializeTuple(&pos, end, &log_record->insert_tuple_);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      ok = DeserializeValue(&pos, end, &log_record->delete_rid_) &&
+           DeserializeTuple(&pos, end, &log_record->delete_tuple_);
+      break;
+    case LogRecordType::UPDATE:
+      ok = DeserializeValue(&pos, end, &log_record->update_rid_) &&
+           DeserializeTuple(&pos, end, &log_record->old_tuple_) && DeserializeTuple(&pos, end, &log_record->new_tuple_);
+      break;
+    case LogRecordType::NEWPAGE:
+      ok = DeserializeValue(&pos, end, &log_record->prev_page_id_) &&
+           DeserializeValue(&pos, end, &log_record->page_id_);
+      break;
+    default:
+      break;
+  }
+  return ok && pos == end;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +109,220 @@ auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  std::vector<std::unique_ptr<RedoWorker>> workers;
+  for (size_t i = 0; i < num_redo_workers_; i++) {
+    workers.push_back(std::make_unique<RedoWorker>());
+    workers.back()->thread_ = std::thread(&LogRecovery::RunRedoWorker, this, workers.back().get());
+  }
+
+  // Read the log a buffer at a time. The records of a buffer go out to the workers in one batch each, in LSN order.
+  offset_ = 0;
+  while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+    std::vector<RedoBatch> batches(num_redo_workers_);
+    auto dispatch = [&](page_id_t page_id, const LogRecord &log_record) {
+      batches[std::hash<page_id_t>{}(page_id) % num_redo_workers_].emplace_back(page_id, log_record);
+    };
+    size_t pos = 0;
+    LogRecord log_record;
+    while (DeserializeLogRecord(log_buffer_ + pos, LOG_BUFFER_SIZE - pos, &log_record)) {
+      lsn_mapping_[log_record.lsn_] = offset_ + static_cast<int>(pos);
+      active_txn_[log_record.txn_id_] = log_record.lsn_;
+      switch (log_record.log_record_type_) {
+        case LogRecordType::COMMIT:
+        case LogRecordType::ABORT:
+          active_txn_.erase(log_record.txn_id_);
+          break;
+        case LogRecordType::INSERT:
+          dispatch(log_record.insert_rid_.GetPageId(), log_record);
+          break;
+        case LogRecordType::MARKDELETE:
+        case LogRecordType::APPLYDELETE:
+        case LogRecordType::ROLLBACKDELETE:
+          dispatch(log_record.delete_rid_.GetPageId(), log_record);
+          break;
+        case LogRecordType::UPDATE:
+          dispatch(log_record.update_rid_.GetPageId(), log_record);
+          break;
+        case LogRecordType::NEWPAGE:
+          // The new page is initialized by its own worker, the link to it from the page before by the worker of that.
+          dispatch(log_record.page_id_, log_record);
+          if (log_record.prev_page_id_ != INVALID_PAGE_ID) {
+            dispatch(log_record.prev_page_id_, log_record);
+          }
+          break;
+        default:
+          break;
+      }
+      pos += log_record.size_;
+    }
+    for (size_t i = 0; i < num_redo_workers_; i++) {
+      if (!batches[i].empty()) {
+        HandOver(workers[i].get(), &batches[i]);
+      }
+    }
+    // A record is never larger than the buffer, so if not even one record is in it, the log ends here.
+    if (pos == 0) {
+      break;
+    }
+    offset_ += static_cast<int>(pos);
+  }
+
+  for (auto &worker : workers) {
+    {
+      std::scoped_lock lock(worker->latch_);
+      worker->done_ = true;
+    }
+    worker->cv_.notify_all();
+  }
+  for (auto &worker : workers) {
+    worker->thread_.join();
+  }
+}
+
+void LogRecovery::HandOver(RedoWorker *worker, RedoBatch *batch) {
+  {
+    std::unique_lock lock(worker->latch_);
+    worker->cv_.wait(lock, [worker] { return worker->batches_.size() < MAX_PENDING_BATCHES; });
+    worker->batches_.push_back(std::move(*batch));
+  }
+  worker->cv_.notify_all();
+}
+
+void LogRecovery::RunRedoWorker(RedoWorker *worker) {
+  std::unique_lock lock(worker->latch_);
+  while (true) {
+    worker->cv_.wait(lock, [worker] { return worker->done_ || !worker->batches_.empty(); });
+    if (worker->batches_.empty()) {
+      return;
+    }
+    RedoBatch batch = std::move(worker->batches_.front());
+    worker->batches_.pop_front();
+    lock.unlock();
+    worker->cv_.notify_all();
+    for (auto &[page_id, log_record] : batch) {
+      RedoLogRecord(page_id, &log_record);
+    }
+    lock.lock();
+  }
+}
+
+void LogRecovery::RedoLogRecord(page_id_t page_id, LogRecord *log_record) {
+  auto *page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ENSURE(page != nullptr, "Couldn't fetch a page to redo a log record on.");
+  page->WLatch();
+  const lsn_t lsn = log_record->lsn_;
+  bool redone = false;
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    if (page_id == log_record->page_id_) {
+      // The allocation of the page may be lost even if the page is not, its map page is written without a sync.
+      disk_manager_->MarkPageAllocated(page_id);
+      // A page that is no table page yet has no LSN to go by.
+      if (page->GetTablePageId() != page_id || page->GetLSN() < lsn) {
+        page->Init(page_id, BUSTUB_PAGE_DATA_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+        page->SetLSN(lsn);
+        redone = true;
+      }
+    } else if (page->GetNextPageId() != log_record->page_id_) {
+      // The link is not logged by itself. Table heaps only ever append pages, so it is right whatever the page LSN.
+      page->SetNextPageId(log_record->page_id_);
+      redone = true;
+    }
+  } else if (page->GetLSN() < lsn) {
+    RID rid;
+    Tuple old_tuple;
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT:
+        page->InsertTuple(log_record->insert_tuple_, &rid, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::UPDATE:
+        page->UpdateTuple(log_record->new_tuple_, &old_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(lsn);
+    redone = true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, redone);
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  // Strict two-phase locking kept the transactions that did not finish off each other's tuples, so each one can be
+  // undone by itself, from its last record back along the prev LSNs.
+  LogRecord log_record;
+  for (const auto &[txn_id, last_lsn] : active_txn_) {
+    lsn_t lsn = last_lsn;
+    while (lsn != INVALID_LSN) {
+      const int offset = lsn_mapping_.at(lsn);
+      BUSTUB_ENSURE(disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset) &&
+                        DeserializeLogRecord(log_buffer_, LOG_BUFFER_SIZE, &log_record),
+                    "Couldn't read back a log record to undo.");
+      UndoLogRecord(&log_record);
+      lsn = log_record.prev_lsn_;
+    }
+  }
+  active_txn_.clear();
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  page_id_t page_id;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page_id = log_record->insert_rid_.GetPageId();
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      page_id = log_record->delete_rid_.GetPageId();
+      break;
+    case LogRecordType::UPDATE:
+      page_id = log_record->update_rid_.GetPageId();
+      break;
+    default:
+      // A new page stays, it is empty once the inserts into it are undone.
+      return;
+  }
+  auto *page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ENSURE(page != nullptr, "Couldn't fetch a page to undo a log record on.");
+  page->WLatch();
+  RID rid;
+  Tuple new_tuple;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->InsertTuple(log_record->delete_tuple_, &rid, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE:
+      page->UpdateTuple(log_record->old_tuple_, &new_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      break;
+    default:
+      break;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 }  // namespace bustub
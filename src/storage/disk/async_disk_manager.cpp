@@ -0,0 +1,289 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * The submission and completion queues of an io_uring instance, mapped into our address space. There is no liburing,
+ * so this talks to the kernel through the raw io_uring_setup and io_uring_enter system calls.
+ */
+struct AsyncDiskManager::Ring {
+  ~Ring() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != nullptr) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  /** Set up a ring with room for at least entries submissions. @return false if io_uring is not available */
+  auto Setup(uint32_t entries) -> bool {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0) {
+      return false;
+    }
+    sq_entries_ = params.sq_entries;
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    // Newer kernels map both queues with a single mmap.
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = Map(sq_size_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == nullptr) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_ : Map(cq_size_, IORING_OFF_CQ_RING);
+    if (cq_ptr_ == nullptr) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  auto Map(size_t size, off_t offset) const -> void * {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  /** Queue a submission and hand it to the kernel. Callers must serialize. */
+  void Submit(uint8_t opcode, int fd, char *data, size_t offset, uint64_t user_data) {
+    const uint32_t tail = *sq_tail_;
+    const uint32_t index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = data == nullptr ? 0 : BUSTUB_PAGE_SIZE;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // The kernel reads the entry once it sees the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0) < 0) {
+      if (errno != EINTR && errno != EAGAIN) {
+        throw Exception("io_uring_enter failed");
+      }
+    }
+  }
+
+  int fd_{-1};
+  uint32_t sq_entries_{0};
+  void *sq_ptr_{nullptr};
+  size_t sq_size_{0};
+  void *cq_ptr_{nullptr};
+  size_t cq_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  uint32_t *sq_tail_{nullptr};
+  uint32_t sq_mask_{0};
+  uint32_t *sq_array_{nullptr};
+  uint32_t *cq_head_{nullptr};
+  uint32_t *cq_tail_{nullptr};
+  uint32_t cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+struct AsyncDiskManager::Request {
+  /** A page aligned for direct I/O. */
+  struct alignas(DIRECT_IO_ALIGNMENT) PageCopy {
+    char data_[BUSTUB_PAGE_SIZE];
+  };
+
+  bool is_write_;
+  page_id_t page_id_;
+  char *data_;
+  std::promise<void> done_;
+  /** With page checksums, the copy of the page a write goes out from, which carries the checksum. */
+  std::unique_ptr<PageCopy> copy_;
+};
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, uint32_t queue_depth, bool direct_io,
+                                   bool page_checksums, bool segment_files)
+    : DiskManager(db_file, direct_io, page_checksums, segment_files), queue_depth_(queue_depth) {
+  BUSTUB_ASSERT(queue_depth > 0, "queue depth must be at least 1");
+  auto ring = std::make_unique<Ring>();
+  if (!ring->Setup(queue_depth)) {
+    LOG_DEBUG("io_uring is not available, falling back to synchronous I/O");
+    return;
+  }
+  // The completion queue is twice as large as the submission queue, so it cannot overflow either.
+  queue_depth_ = std::min(queue_depth, ring->sq_entries_);
+  ring_ = std::move(ring);
+  completion_thread_ = std::make_unique<std::thread>(&AsyncDiskManager::ReapCompletions, this);
+}
+
+AsyncDiskManager::~AsyncDiskManager() { StopRing(); }
+
+void AsyncDiskManager::ShutDown() {
+  StopRing();
+  DiskManager::ShutDown();
+}
+
+void AsyncDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (!IsAsync() || NeedsBounceBuffer(page_data)) {
+    DiskManager::WritePage(page_id, page_data);
+    return;
+  }
+  WritePageAsync(page_id, page_data).get();
+}
+
+void AsyncDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (!IsAsync() || NeedsBounceBuffer(page_data)) {
+    DiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  ReadPageAsync(page_id, page_data).get();
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  if (!IsAsync() || NeedsBounceBuffer(page_data)) {
+    return DiskManager::ReadPageAsync(page_id, page_data);
+  }
+  return Submit(std::unique_ptr<Request>(new Request{false, page_id, page_data, {}, nullptr}));
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  if (!IsAsync() || NeedsBounceBuffer(page_data)) {
+    return DiskManager::WritePageAsync(page_id, page_data);
+  }
+  num_writes_ += 1;
+  // The kernel only reads from the buffer of a write.
+  auto request = std::unique_ptr<Request>(new Request{true, page_id, const_cast<char *>(page_data), {}, nullptr});
+  if (page_checksums_) {
+    request->copy_ = std::make_unique<Request::PageCopy>();
+    memcpy(request->copy_->data_, page_data, BUSTUB_PAGE_SIZE);
+    SetPageChecksum(request->copy_->data_);
+    request->data_ = request->copy_->data_;
+  }
+  return Submit(std::move(request));
+}
+
+auto AsyncDiskManager::Submit(std::unique_ptr<Request> request) -> std::future<void> {
+  auto done = request->done_.get_future();
+  std::unique_lock lock(submit_latch_);
+  request_done_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+  const uint8_t opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+  const size_t offset = PageOffset(request->page_id_);
+  // A page of a segment that does not exist fails, and Complete reports it like DiskManager does.
+  SegmentFile *file = FileOf(request->page_id_);
+  const int fd = file != nullptr ? file->fd_ : -1;
+  char *data = request->data_;
+  // The completion thread takes ownership of the request when it reaps its completion.
+  ring_->Submit(opcode, fd, data, offset, reinterpret_cast<uint64_t>(request.release()));
+  in_flight_++;
+  return done;
+}
+
+void AsyncDiskManager::ReapCompletions() {
+  while (true) {
+    if (syscall(__NR_io_uring_enter, ring_->fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed while waiting for completions");
+    }
+    uint32_t head = *ring_->cq_head_;
+    const uint32_t tail = __atomic_load_n(ring_->cq_tail_, __ATOMIC_ACQUIRE);
+    bool stop = false;
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = ring_->cqes_[head & ring_->cq_mask_];
+      // The no-op submitted by StopRing is the only request without a Request.
+      if (cqe.user_data == 0) {
+        stop = true;
+        continue;
+      }
+      Complete(reinterpret_cast<Request *>(cqe.user_data), cqe.res);
+    }
+    // Hand the reaped entries back to the kernel.
+    __atomic_store_n(ring_->cq_head_, head, __ATOMIC_RELEASE);
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void AsyncDiskManager::Complete(Request *request, int result) {
+  std::unique_ptr<Request> owned(request);
+  if (result != BUSTUB_PAGE_SIZE) {
+    // A short transfer, e.g. a read at the end of the file, or an error. Redo the page synchronously, which zero-fills
+    // reads past the end of the file and reports errors the same way.
+    if (request->is_write_) {
+      DiskManager::WritePage(request->page_id_, request->data_);
+    } else {
+      DiskManager::ReadPage(request->page_id_, request->data_);
+    }
+  } else if (request->is_write_) {
+    GrowFileSize(FileOf(request->page_id_), PageOffset(request->page_id_) + BUSTUB_PAGE_SIZE);
+  } else {
+    VerifyPageChecksum(request->page_id_, request->data_);
+  }
+  request->done_.set_value();
+  {
+    std::scoped_lock lock(submit_latch_);
+    in_flight_--;
+  }
+  request_done_.notify_all();
+}
+
+void AsyncDiskManager::StopRing() {
+  if (ring_ == nullptr) {
+    return;
+  }
+  {
+    std::unique_lock lock(submit_latch_);
+    request_done_.wait(lock, [this] { return in_flight_ == 0; });
+    ring_->Submit(IORING_OP_NOP, -1, nullptr, 0, 0);
+  }
+  completion_thread_->join();
+  completion_thread_.reset();
+  ring_.reset();
+}
+
+}  // namespace bustub
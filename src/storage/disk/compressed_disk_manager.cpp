@@ -0,0 +1,387 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager.cpp
+//
+// Identification: src/storage/disk/compressed_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/compressed_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/page_codec.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr uint64_t SUPERBLOCK_MAGIC = 0x4253554243505a31;  // "BSUBCPZ1"
+
+/** Sits at offset 0 and points at the last checkpoint. */
+struct Superblock {
+  uint64_t magic_;
+  uint64_t checkpoint_offset_;
+  uint64_t checkpoint_size_;
+};
+
+/**
+ * A checkpoint is this header, followed by a CheckpointEntry for each stored page, followed by the map pages of the
+ * FreeSpaceMap.
+ */
+struct CheckpointHeader {
+  uint64_t num_entries_;
+  uint64_t num_map_pages_;
+};
+
+struct CheckpointEntry {
+  page_id_t page_id_;
+  uint32_t size_;
+  uint64_t offset_;
+};
+
+}  // namespace
+
+CompressedDiskManager::CompressedDiskManager(const std::string &db_file, bool page_checksums) {
+  file_name_ = db_file;
+  page_checksums_ = page_checksums;
+  if (!OpenLog()) {
+    return;
+  }
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  LoadCheckpoint();
+}
+
+CompressedDiskManager::~CompressedDiskManager() {
+  if (fd_ >= 0) {
+    Checkpoint();
+    close(fd_);
+  }
+}
+
+void CompressedDiskManager::ShutDown() {
+  if (fd_ >= 0) {
+    Checkpoint();
+    close(fd_);
+    fd_ = -1;
+  }
+  DiskManager::ShutDown();
+}
+
+void CompressedDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  char copy[BUSTUB_PAGE_SIZE];
+  if (page_checksums_) {
+    memcpy(copy, page_data, BUSTUB_PAGE_SIZE);
+    SetPageChecksum(copy);
+    page_data = copy;
+  }
+  char compressed[PageCodec::MaxCompressedSize(BUSTUB_PAGE_SIZE)];
+  size_t size = PageCodec::Compress(page_data, BUSTUB_PAGE_SIZE, compressed);
+  const char *data = compressed;
+  if (size >= BUSTUB_PAGE_SIZE) {
+    size = BUSTUB_PAGE_SIZE;
+    data = page_data;
+  }
+
+  // A checkpoint must not snapshot the page map between the slot assignment and the write that fills the slot.
+  std::shared_lock write_lock(write_latch_);
+  uint64_t offset;
+  {
+    std::scoped_lock lock(latch_);
+    auto it = slots_.find(page_id);
+    if (it != slots_.end() && !it->second.checkpointed_ && SlotSize(it->second.size_) == SlotSize(size)) {
+      offset = it->second.offset_;
+      stored_bytes_ -= it->second.size_;
+    } else {
+      if (it != slots_.end()) {
+        ReleaseSlot(it->second);
+        stored_bytes_ -= it->second.size_;
+      }
+      offset = AllocateExtent(SlotSize(size));
+    }
+    slots_[page_id] = Slot{offset, static_cast<uint32_t>(size), false};
+    stored_bytes_ += size;
+  }
+  num_writes_ += 1;
+  WriteBytes(offset, data, size);
+}
+
+void CompressedDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  Slot slot;
+  {
+    std::scoped_lock lock(latch_);
+    auto it = slots_.find(page_id);
+    if (it == slots_.end()) {
+      // never written, like a page past the end of the file of DiskManager
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+      return;
+    }
+    slot = it->second;
+  }
+  if (slot.size_ == BUSTUB_PAGE_SIZE) {
+    if (!ReadBytes(slot.offset_, page_data, BUSTUB_PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while reading");
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    }
+  } else {
+    char compressed[BUSTUB_PAGE_SIZE];
+    if (!ReadBytes(slot.offset_, compressed, slot.size_) ||
+        !PageCodec::Decompress(compressed, slot.size_, page_data, BUSTUB_PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while reading a compressed page");
+      memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    }
+  }
+  VerifyPageChecksum(page_id, page_data);
+}
+
+void CompressedDiskManager::SyncPages() {
+  if (fd_ < 0) {
+    return;
+  }
+  Checkpoint();
+}
+
+void CompressedDiskManager::DeallocatePage(page_id_t page_id) {
+  {
+    std::scoped_lock lock(latch_);
+    auto it = slots_.find(page_id);
+    if (it != slots_.end()) {
+      ReleaseSlot(it->second);
+      stored_bytes_ -= it->second.size_;
+      slots_.erase(it);
+    }
+  }
+  DiskManager::DeallocatePage(page_id);
+}
+
+auto CompressedDiskManager::GetNumStoredPages() -> size_t {
+  std::scoped_lock lock(latch_);
+  return slots_.size();
+}
+
+auto CompressedDiskManager::GetStoredBytes() -> size_t {
+  std::scoped_lock lock(latch_);
+  return stored_bytes_;
+}
+
+auto CompressedDiskManager::GetFileEnd() -> size_t {
+  std::scoped_lock lock(latch_);
+  return file_end_;
+}
+
+auto CompressedDiskManager::AllocateExtent(size_t size) -> uint64_t {
+  for (auto it = free_extents_.begin(); it != free_extents_.end(); ++it) {
+    if (it->second < size) {
+      continue;
+    }
+    const uint64_t offset = it->first;
+    const uint64_t rest = it->second - size;
+    free_extents_.erase(it);
+    if (rest > 0) {
+      free_extents_.emplace(offset + size, rest);
+    }
+    return offset;
+  }
+  const uint64_t offset = file_end_;
+  file_end_ += size;
+  return offset;
+}
+
+void CompressedDiskManager::FreeExtent(uint64_t offset, size_t size) {
+  auto next = free_extents_.lower_bound(offset);
+  if (next != free_extents_.end() && offset + size == next->first) {
+    size += next->second;
+    next = free_extents_.erase(next);
+  }
+  if (next != free_extents_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      size += prev->second;
+      free_extents_.erase(prev);
+    }
+  }
+  // Free space at the end of the file is given back to the file system by the next checkpoint.
+  if (offset + size == file_end_) {
+    file_end_ = offset;
+    return;
+  }
+  free_extents_.emplace(offset, size);
+}
+
+void CompressedDiskManager::ReleaseSlot(const Slot &slot) {
+  if (slot.checkpointed_) {
+    pending_free_.emplace_back(slot.offset_, SlotSize(slot.size_));
+  } else {
+    FreeExtent(slot.offset_, SlotSize(slot.size_));
+  }
+}
+
+void CompressedDiskManager::WriteBytes(uint64_t offset, const char *data, size_t size) {
+  size_t write_count = 0;
+  while (write_count < size) {
+    ssize_t rc = pwrite(fd_, data + write_count, size - write_count, offset + write_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    write_count += rc;
+  }
+}
+
+auto CompressedDiskManager::ReadBytes(uint64_t offset, char *data, size_t size) -> bool {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t rc = pread(fd_, data + read_count, size - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    // end of file
+    if (rc == 0) {
+      return false;
+    }
+    read_count += rc;
+  }
+  return true;
+}
+
+void CompressedDiskManager::LoadCheckpoint() {
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    return;
+  }
+  Superblock superblock{};
+  if (!ReadBytes(0, reinterpret_cast<char *>(&superblock), sizeof(superblock))) {
+    throw Exception("can't read the superblock of the db file");
+  }
+  // Pages were written, but the file did not see a checkpoint before it was closed, so none of them counts.
+  if (superblock.magic_ == 0) {
+    return;
+  }
+  if (superblock.magic_ != SUPERBLOCK_MAGIC) {
+    throw Exception("db file was not written by CompressedDiskManager");
+  }
+  std::vector<char> checkpoint(superblock.checkpoint_size_);
+  if (!ReadBytes(superblock.checkpoint_offset_, checkpoint.data(), checkpoint.size())) {
+    throw Exception("can't read the checkpoint of the db file");
+  }
+  CheckpointHeader header;
+  memcpy(&header, checkpoint.data(), sizeof(header));
+  const char *entries = checkpoint.data() + sizeof(header);
+  const char *map_pages = entries + header.num_entries_ * sizeof(CheckpointEntry);
+
+  // Every extent in use, the free space of the file is what lies between them.
+  std::vector<std::pair<uint64_t, uint64_t>> extents;
+  for (uint64_t i = 0; i < header.num_entries_; i++) {
+    CheckpointEntry entry;
+    memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+    slots_[entry.page_id_] = Slot{entry.offset_, entry.size_, true};
+    stored_bytes_ += entry.size_;
+    extents.emplace_back(entry.offset_, SlotSize(entry.size_));
+  }
+  for (uint64_t i = 0; i < header.num_map_pages_; i++) {
+    DbFile().free_space_map_.LoadMapPage(i, map_pages + i * BUSTUB_PAGE_SIZE);
+  }
+  checkpoint_extent_ = {superblock.checkpoint_offset_, SlotSize(superblock.checkpoint_size_)};
+  extents.push_back(checkpoint_extent_);
+
+  std::sort(extents.begin(), extents.end());
+  uint64_t end = SLOT_ALIGNMENT;
+  for (const auto &[offset, size] : extents) {
+    if (offset > end) {
+      free_extents_.emplace(end, offset - end);
+    }
+    end = std::max(end, offset + size);
+  }
+  // Slots written after the checkpoint were lost, the next checkpoint cuts them off.
+  file_end_ = end;
+}
+
+void CompressedDiskManager::Checkpoint() {
+  std::scoped_lock checkpoint_lock(checkpoint_latch_);
+  std::vector<char> checkpoint;
+  uint64_t checkpoint_offset;
+  std::vector<std::pair<uint64_t, uint64_t>> to_free;
+  {
+    // Waits for the page writes in flight, so that every slot of the snapshot holds its page.
+    std::unique_lock write_lock(write_latch_);
+    std::scoped_lock lock(latch_);
+    CheckpointHeader header{slots_.size(), 0};
+    {
+      std::scoped_lock free_space_lock(free_space_latch_);
+      header.num_map_pages_ = DbFile().free_space_map_.GetNumMapPages();
+      checkpoint.resize(sizeof(header) + header.num_entries_ * sizeof(CheckpointEntry) +
+                        header.num_map_pages_ * BUSTUB_PAGE_SIZE);
+      char *map_pages = checkpoint.data() + sizeof(header) + header.num_entries_ * sizeof(CheckpointEntry);
+      for (size_t i = 0; i < header.num_map_pages_; i++) {
+        DbFile().free_space_map_.StoreMapPage(i, map_pages + i * BUSTUB_PAGE_SIZE);
+      }
+    }
+    memcpy(checkpoint.data(), &header, sizeof(header));
+    char *entries = checkpoint.data() + sizeof(header);
+    for (auto &[page_id, slot] : slots_) {
+      CheckpointEntry entry{page_id, slot.size_, slot.offset_};
+      memcpy(entries, &entry, sizeof(entry));
+      entries += sizeof(entry);
+      slot.checkpointed_ = true;
+    }
+
+    // Cut off the free space at the end of the file; no write is in flight, so nothing is written past file_end_.
+    struct stat stat_buf;
+    if (fstat(fd_, &stat_buf) == 0 && static_cast<uint64_t>(stat_buf.st_size) > file_end_ &&
+        ftruncate(fd_, static_cast<off_t>(file_end_)) != 0) {
+      LOG_DEBUG("I/O error while truncating");
+    }
+    checkpoint_offset = AllocateExtent(SlotSize(checkpoint.size()));
+    // The slots given up before the snapshot, and the last checkpoint, are free once this checkpoint is durable.
+    to_free = std::move(pending_free_);
+    pending_free_.clear();
+    if (checkpoint_extent_.second > 0) {
+      to_free.push_back(checkpoint_extent_);
+    }
+    checkpoint_extent_ = {checkpoint_offset, SlotSize(checkpoint.size())};
+  }
+
+  // The checkpoint and the pages it refers to must be durable before the superblock points at them.
+  WriteBytes(checkpoint_offset, checkpoint.data(), checkpoint.size());
+  num_syncs_ += 1;
+  if (fdatasync(fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  char superblock[SLOT_ALIGNMENT] = {};
+  Superblock header{SUPERBLOCK_MAGIC, checkpoint_offset, checkpoint.size()};
+  memcpy(superblock, &header, sizeof(header));
+  WriteBytes(0, superblock, sizeof(superblock));
+  num_syncs_ += 1;
+  if (fdatasync(fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+
+  std::scoped_lock lock(latch_);
+  for (const auto &[offset, size] : to_free) {
+    FreeExtent(offset, size);
+  }
+}
+
+}  // namespace bustub
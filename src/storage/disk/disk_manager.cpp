@@ -10,31 +10,141 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Sync the directory of a file, so that the file is still there after a crash. */
+static void SyncDirectory(const std::string &file_name) {
+  const std::filesystem::path parent = std::filesystem::path(file_name).parent_path();
+  const int fd = open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  if (fsync(fd) != 0) {
+    LOG_DEBUG("I/O error while syncing a directory");
+  }
+  close(fd);
+}
+
+DiskManager::DiskManager() : segments_(MAX_SEGMENTS) {
+  segments_[DEFAULT_SEGMENT_ID] = std::make_unique<SegmentFile>();
+}
+
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create the database file & log file, and open the segment files next to them
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, bool page_checksums, bool segment_files)
+    : direct_io_(direct_io),
+      page_checksums_(page_checksums),
+      segment_files_(segment_files),
+      file_name_(db_file),
+      segments_(MAX_SEGMENTS) {
+  segments_[DEFAULT_SEGMENT_ID] = std::make_unique<SegmentFile>();
+  if (!OpenLog()) {
+    direct_io_ = false;
+    return;
+  }
+
+  // open the db file, or create it if it does not exist
+  auto db = OpenSegmentFile(db_file, O_CREAT);
+  if (db == nullptr) {
+    throw Exception("can't open db file");
+  }
+  direct_io_ = direct_io_ && (fcntl(db->fd_, F_GETFL) & O_DIRECT) != 0;
+  segments_[DEFAULT_SEGMENT_ID] = std::move(db);
+  buffer_used = nullptr;
+  if (segment_files_) {
+    OpenSegmentFiles();
+  }
+}
+
+auto DiskManager::OpenSegmentFile(const std::string &file_name, int open_flags) -> std::unique_ptr<SegmentFile> {
+  auto file = std::make_unique<SegmentFile>();
+  if (direct_io_) {
+    file->fd_ = open(file_name.c_str(), O_RDWR | O_DIRECT | open_flags, 0644);
+    // some file systems, e.g. tmpfs, do not support O_DIRECT
+    if (file->fd_ < 0 && errno == EINVAL) {
+      LOG_DEBUG("O_DIRECT is not supported for %s, using buffered I/O", file_name.c_str());
+    }
+  }
+  if (file->fd_ < 0) {
+    file->fd_ = open(file_name.c_str(), O_RDWR | open_flags, 0644);
+  }
+  if (file->fd_ < 0) {
+    return nullptr;
+  }
+  struct stat stat_buf;
+  if (fstat(file->fd_, &stat_buf) == 0) {
+    file->size_ = static_cast<size_t>(stat_buf.st_size);
+    file->reserved_ = file->size_;
+  }
+
+  // load the free space map of an existing file
+  alignas(DIRECT_IO_ALIGNMENT) char map_page[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; MapPageOffset(i) < file->size_; i++) {
+    ReadAt(file.get(), MapPageOffset(i), map_page);
+    file->free_space_map_.LoadMapPage(i, map_page);
+  }
+  return file;
+}
+
+void DiskManager::OpenSegmentFiles() {
+  // The segment files are named after the db file, followed by a dot and the segment id.
+  const std::filesystem::path db_path(file_name_);
+  const std::string prefix = db_path.filename().string() + ".";
+  const std::filesystem::path dir = db_path.has_parent_path() ? db_path.parent_path() : std::filesystem::path(".");
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    const std::string suffix = name.substr(prefix.size());
+    const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+    if (suffix.size() > 4 || suffix[0] == '0' || !std::all_of(suffix.begin(), suffix.end(), is_digit)) {
+      continue;
+    }
+    const segment_id_t segment = std::stoi(suffix);
+    if (segment >= MAX_SEGMENTS) {
+      continue;
+    }
+    auto file = OpenSegmentFile(GetSegmentFileName(segment), 0);
+    if (file == nullptr) {
+      throw Exception("can't open segment file");
+    }
+    segments_[segment] = std::move(file);
+  }
+}
+
+auto DiskManager::OpenLog() -> bool {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
-    return;
+    return false;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
@@ -48,19 +158,20 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw Exception("can't open dblog file");
     }
   }
+  // the stream cannot sync the file, a descriptor of it can
+  log_fd_ = open(log_name_.c_str(), O_WRONLY);
+  return true;
+}
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+DiskManager::~DiskManager() {
+  for (auto &file : segments_) {
+    if (file != nullptr && file->fd_ >= 0) {
+      close(file->fd_);
     }
   }
-  buffer_used = nullptr;
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
 }
 
 /**
@@ -68,56 +179,463 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
  */
 void DiskManager::ShutDown() {
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::scoped_lock lock(segments_latch_);
+    for (auto &file : segments_) {
+      if (file != nullptr && file->fd_ >= 0) {
+        close(file->fd_);
+        file->fd_ = -1;
+      }
+    }
   }
   log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  // The page goes out from a copy if it needs a checksum, or a buffer that is aligned for direct I/O
+  if (page_checksums_ || NeedsBounceBuffer(page_data)) {
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char copy[BUSTUB_PAGE_SIZE];
+    memcpy(copy, page_data, BUSTUB_PAGE_SIZE);
+    if (page_checksums_) {
+      SetPageChecksum(copy);
+    }
+    page_data = copy;
+  }
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  WriteAt(FileOf(page_id), PageOffset(page_id), page_data);
+}
+
+void DiskManager::WriteAt(SegmentFile *file, size_t offset, const char *data) {
+  if (file == nullptr) {
+    LOG_DEBUG("I/O error writing to a segment that does not exist");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  size_t write_count = 0;
+  while (write_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pwrite(file->fd_, data + write_count, BUSTUB_PAGE_SIZE - write_count, offset + write_count);
+    // check for I/O error
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    write_count += rc;
+  }
+  // the file may have grown, remember its new size
+  GrowFileSize(file, offset + BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * @return the end of the run of pages that starts at begin, in pages sorted by page id. A run ends where the page ids
+ * stop being consecutive, at a map page, which sits between two runs of pages, and at IOV_MAX pages. Segments hold a
+ * whole number of map pages, so a run also ends with its segment.
+ */
+template <typename PageData>
+static auto RunEnd(const std::vector<std::pair<page_id_t, PageData>> &pages, size_t begin) -> size_t {
+  const page_id_t map_page_end =
+      static_cast<page_id_t>(FreeSpaceMap::MapPageOf(pages[begin].first) + 1) * FreeSpaceMap::PAGES_PER_MAP_PAGE;
+  size_t end = begin + 1;
+  while (end < pages.size() && pages[end].first == pages[end - 1].first + 1 && pages[end].first < map_page_end &&
+         end - begin < static_cast<size_t>(IOV_MAX)) {
+    end++;
+  }
+  return end;
+}
+
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  std::vector<std::future<void>> writes;
+  std::vector<const char *> run;
+  for (size_t begin = 0; begin < pages.size();) {
+    const size_t end = RunEnd(pages, begin);
+    run.clear();
+    for (size_t i = begin; i < end; i++) {
+      run.push_back(pages[i].second);
+    }
+    // Without a file of our own, or with a buffer that needs the bounce buffer, the pages go one at a time. Copies
+    // made for the checksums are aligned.
+    SegmentFile *file = FileOf(pages[begin].first);
+    const bool vectored =
+        run.size() > 1 && file != nullptr && file->fd_ >= 0 &&
+        (page_checksums_ ||
+         std::none_of(run.begin(), run.end(), [this](auto data) { return NeedsBounceBuffer(data); }));
+    if (vectored) {
+      std::unique_ptr<char, decltype(&std::free)> copies(nullptr, &std::free);
+      if (page_checksums_) {
+        copies.reset(static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, run.size() * BUSTUB_PAGE_SIZE)));
+        for (size_t i = 0; i < run.size(); i++) {
+          char *copy = copies.get() + i * BUSTUB_PAGE_SIZE;
+          memcpy(copy, run[i], BUSTUB_PAGE_SIZE);
+          SetPageChecksum(copy);
+          run[i] = copy;
+        }
+      }
+      num_writes_ += static_cast<int>(run.size());
+      WriteRunAt(file, PageOffset(pages[begin].first), run.data(), run.size());
+    } else {
+      for (size_t i = begin; i < end; i++) {
+        writes.push_back(WritePageAsync(pages[i].first, pages[i].second));
+      }
+    }
+    begin = end;
+  }
+  for (auto &write : writes) {
+    write.get();
+  }
+}
+
+void DiskManager::WriteRunAt(SegmentFile *file, size_t offset, const char *const *pages_data, size_t num_pages) {
+  std::vector<iovec> iov(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    iov[i].iov_base = const_cast<char *>(pages_data[i]);  // NOLINT
+    iov[i].iov_len = BUSTUB_PAGE_SIZE;
+  }
+  const size_t size = num_pages * BUSTUB_PAGE_SIZE;
+  size_t write_count = 0;
+  size_t first = 0;
+  while (write_count < size) {
+    ssize_t rc = pwritev(file->fd_, &iov[first], static_cast<int>(iov.size() - first), offset + write_count);
+    // check for I/O error
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    write_count += rc;
+    // after a short write, skip the buffers that were written and trim the one that was written in part
+    auto written = static_cast<size_t>(rc);
+    while (first < iov.size() && written >= iov[first].iov_len) {
+      written -= iov[first].iov_len;
+      first++;
+    }
+    if (first < iov.size()) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + written;
+      iov[first].iov_len -= written;
+    }
+  }
+  // the file may have grown, remember its new size
+  GrowFileSize(file, offset + size);
+}
+
+void DiskManager::GrowFileSize(SegmentFile *file, size_t end) {
+  size_t file_size = file->size_.load();
+  while (file_size < end && !file->size_.compare_exchange_weak(file_size, end)) {
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  if (NeedsBounceBuffer(page_data)) {
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[BUSTUB_PAGE_SIZE];
+    ReadPage(page_id, bounce);
+    memcpy(page_data, bounce, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  ReadAt(FileOf(page_id), PageOffset(page_id), page_data);
+  VerifyPageChecksum(page_id, page_data);
+}
+
+void DiskManager::ReadAt(SegmentFile *file, size_t offset, char *data) {
+  if (file == nullptr) {
+    LOG_DEBUG("I/O error reading from a segment that does not exist");
+    memset(data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= file->size_.load()) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pread(file->fd_, data + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    // end of file
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading BUSTUB_PAGE_SIZE
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+void DiskManager::ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  std::vector<std::future<void>> reads;
+  std::vector<char *> run;
+  for (size_t begin = 0; begin < pages.size();) {
+    const size_t end = RunEnd(pages, begin);
+    run.clear();
+    for (size_t i = begin; i < end; i++) {
+      run.push_back(pages[i].second);
+    }
+    SegmentFile *file = FileOf(pages[begin].first);
+    const bool vectored = run.size() > 1 && file != nullptr && file->fd_ >= 0 &&
+                          std::none_of(run.begin(), run.end(), [this](auto data) { return NeedsBounceBuffer(data); });
+    if (vectored) {
+      ReadRunAt(file, PageOffset(pages[begin].first), run.data(), run.size());
+      for (size_t i = begin; i < end; i++) {
+        VerifyPageChecksum(pages[i].first, pages[i].second);
+      }
+    } else {
+      for (size_t i = begin; i < end; i++) {
+        reads.push_back(ReadPageAsync(pages[i].first, pages[i].second));
+      }
+    }
+    begin = end;
+  }
+  for (auto &read : reads) {
+    read.get();
+  }
+}
+
+void DiskManager::ReadRunAt(SegmentFile *file, size_t offset, char *const *pages_data, size_t num_pages) {
+  std::vector<iovec> iov(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    iov[i].iov_base = pages_data[i];
+    iov[i].iov_len = BUSTUB_PAGE_SIZE;
+  }
+  const size_t size = num_pages * BUSTUB_PAGE_SIZE;
+  size_t read_count = 0;
+  size_t first = 0;
+  while (read_count < size) {
+    ssize_t rc = preadv(file->fd_, &iov[first], static_cast<int>(iov.size() - first), offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    // end of file, the rest of the run reads as zeros
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+    // after a short read, skip the buffers that were filled and trim the one that was filled in part
+    auto read = static_cast<size_t>(rc);
+    while (first < iov.size() && read >= iov[first].iov_len) {
+      read -= iov[first].iov_len;
+      first++;
+    }
+    if (first < iov.size()) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + read;
+      iov[first].iov_len -= read;
+    }
+  }
+  for (size_t i = first; i < iov.size(); i++) {
+    memset(iov[i].iov_base, 0, iov[i].iov_len);
+  }
+}
+
+auto DiskManager::AllocatePage(page_id_t near_page_id, uint32_t num_instances, uint32_t instance_index) -> page_id_t {
+  const page_id_t first =
+      near_page_id == INVALID_PAGE_ID || !segment_files_ ? 0 : SegmentHeaderPageId(SegmentOf(near_page_id));
+  // The map of a segment counts from its first page, which shifts the indexes that belong to the instance.
+  const uint32_t index_in_segment =
+      (instance_index + num_instances - static_cast<uint32_t>(first) % num_instances) % num_instances;
+  std::scoped_lock lock(free_space_latch_);
+  SegmentFile *file = FileOf(first);
+  if (file == nullptr) {
+    throw Exception("can't allocate a page in a segment that does not exist");
+  }
+  const page_id_t near_index = near_page_id == INVALID_PAGE_ID ? INVALID_PAGE_ID : near_page_id - first;
+  const page_id_t index = file->free_space_map_.Allocate(near_index, num_instances, index_in_segment);
+  if (segment_files_ && index >= PAGES_PER_SEGMENT) {
+    file->free_space_map_.Deallocate(index);
+    throw Exception("segment is full");
+  }
+  StoreMapPage(file, FreeSpaceMap::MapPageOf(index));
+  ReserveExtents(file, index);
+  return first + index;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock(free_space_latch_);
+  SegmentFile *file = FileOf(page_id);
+  const page_id_t index = IndexOf(page_id);
+  if (file != nullptr && file->free_space_map_.Deallocate(index)) {
+    StoreMapPage(file, FreeSpaceMap::MapPageOf(index));
+  }
+}
+
+void DiskManager::MarkPageAllocated(page_id_t page_id) {
+  std::scoped_lock lock(free_space_latch_);
+  SegmentFile *file = FileOf(page_id);
+  const page_id_t index = IndexOf(page_id);
+  if (file != nullptr && file->free_space_map_.MarkAllocated(index)) {
+    StoreMapPage(file, FreeSpaceMap::MapPageOf(index));
+    ReserveExtents(file, index);
+  }
+}
+
+auto DiskManager::GetNumAllocatedPages() -> size_t {
+  std::scoped_lock lock(segments_latch_, free_space_latch_);
+  size_t num_allocated = 0;
+  for (auto &file : segments_) {
+    if (file != nullptr) {
+      num_allocated += file->free_space_map_.GetNumAllocated();
+    }
+  }
+  return num_allocated;
+}
+
+auto DiskManager::IsPageAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock lock(free_space_latch_);
+  SegmentFile *file = FileOf(page_id);
+  return file != nullptr && file->free_space_map_.IsAllocated(IndexOf(page_id));
+}
+
+void DiskManager::StoreMapPage(SegmentFile *file, size_t map_page) {
+  // DiskManagerMemory has no file, its map lives in memory only
+  if (file->fd_ < 0) {
+    return;
+  }
+  alignas(DIRECT_IO_ALIGNMENT) char data[BUSTUB_PAGE_SIZE];
+  file->free_space_map_.StoreMapPage(map_page, data);
+  WriteAt(file, MapPageOffset(map_page), data);
+}
+
+void DiskManager::ReserveExtents(SegmentFile *file, page_id_t index) {
+  const size_t end = IndexOffset(index) + BUSTUB_PAGE_SIZE;
+  if (file->fd_ < 0 || end <= file->reserved_) {
+    return;
+  }
+  constexpr size_t extent_size = EXTENT_PAGES * BUSTUB_PAGE_SIZE;
+  const size_t reserved = (end + extent_size - 1) / extent_size * extent_size;
+  // The size of the file stays as it is, so reads past the written pages still see the end of the file. This is only
+  // a hint to the file system; one that cannot preallocate grows the file page by page.
+  if (fallocate(file->fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(file->reserved_),
+                static_cast<off_t>(reserved - file->reserved_)) != 0) {
+    LOG_DEBUG("could not preallocate an extent");
+  }
+  file->reserved_ = reserved;
+}
+
+auto DiskManager::CreateSegment() -> segment_id_t {
+  if (!segment_files_ || DbFile().fd_ < 0) {
+    return DEFAULT_SEGMENT_ID;
+  }
+  std::scoped_lock lock(segments_latch_);
+  const auto free = std::find(segments_.begin() + 1, segments_.end(), nullptr);
+  if (free == segments_.end()) {
+    throw Exception("too many segments");
+  }
+  const auto segment = static_cast<segment_id_t>(free - segments_.begin());
+  auto file = OpenSegmentFile(GetSegmentFileName(segment), O_CREAT | O_TRUNC);
+  if (file == nullptr) {
+    throw Exception("can't create segment file");
+  }
+  {
+    std::scoped_lock free_space_lock(free_space_latch_);
+    file->free_space_map_.Allocate();
+    StoreMapPage(file.get(), 0);
+    ReserveExtents(file.get(), 0);
+  }
+  // A crash must not lose the file, with the pages that will be written to it.
+  SyncDirectory(file_name_);
+  *free = std::move(file);
+  return segment;
+}
+
+auto DiskManager::DeleteSegment(segment_id_t segment) -> bool {
+  if (segment <= DEFAULT_SEGMENT_ID || segment >= MAX_SEGMENTS) {
+    return false;
+  }
+  std::unique_ptr<SegmentFile> file;
+  {
+    std::scoped_lock lock(segments_latch_);
+    file = std::move(segments_[segment]);
+  }
+  if (file == nullptr) {
+    return false;
+  }
+  if (file->fd_ >= 0) {
+    close(file->fd_);
+  }
+  // The pages of the segment are gone with its file, all at once.
+  if (unlink(GetSegmentFileName(segment).c_str()) != 0) {
+    LOG_DEBUG("could not remove segment file");
+  }
+  return true;
+}
+
+auto DiskManager::HasSegment(segment_id_t segment) -> bool {
+  std::scoped_lock lock(segments_latch_);
+  return segment >= 0 && segment < MAX_SEGMENTS && segments_[segment] != nullptr;
+}
+
+void DiskManager::SetPageChecksum(char *page_data) {
+  static_assert(BUSTUB_PAGE_TRAILER_SIZE == sizeof(uint32_t));
+  const uint32_t checksum = Crc32c::Compute(page_data, BUSTUB_PAGE_DATA_SIZE);
+  memcpy(page_data + BUSTUB_PAGE_DATA_SIZE, &checksum, sizeof(checksum));
+}
+
+auto DiskManager::IsPageChecksumValid(const char *page_data) -> bool {
+  uint32_t checksum;
+  memcpy(&checksum, page_data + BUSTUB_PAGE_DATA_SIZE, sizeof(checksum));
+  if (checksum == Crc32c::Compute(page_data, BUSTUB_PAGE_DATA_SIZE)) {
+    return true;
+  }
+  return checksum == 0 && std::all_of(page_data, page_data + BUSTUB_PAGE_DATA_SIZE, [](char c) { return c == 0; });
+}
+
+void DiskManager::VerifyPageChecksum(page_id_t page_id, const char *page_data) {
+  if (page_checksums_ && !IsPageChecksumValid(page_data)) {
+    num_checksum_failures_ += 1;
+    LOG_DEBUG("checksum mismatch in page %d, it is corrupt or was torn by a crash", page_id);
+  }
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  ReadPage(page_id, page_data);
+  std::promise<void> done;
+  done.set_value();
+  return done.get_future();
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  WritePage(page_id, page_data);
+  std::promise<void> done;
+  done.set_value();
+  return done.get_future();
+}
+
+/**
+ * Sync the page writes made so far to disk
+ */
+void DiskManager::SyncPages() {
+  if (DbFile().fd_ < 0) {
+    return;
+  }
+  num_syncs_ += 1;
+  std::scoped_lock lock(segments_latch_);
+  for (auto &file : segments_) {
+    if (file != nullptr && fdatasync(file->fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing");
     }
   }
 }
@@ -153,6 +671,9 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
+  if (log_fd_ >= 0 && fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
   flush_log_ = false;
 }
 
@@ -12,6 +12,7 @@
 
 #include "storage/disk/disk_manager_memory.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
@@ -27,24 +28,189 @@ namespace bustub {
 /**
  * Constructor: used for memory based manager
  */
-DiskManagerMemory::DiskManagerMemory(size_t pages) { memory_ = new char[pages * BUSTUB_PAGE_SIZE]; }
+DiskManagerMemory::DiskManagerMemory(size_t pages, const DiskLatencyModel &model)
+    : model_(model), slots_(model.queue_depth_) {
+  chunks_.reserve((pages + CHUNK_PAGES - 1) / CHUNK_PAGES);
+}
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
+  memcpy(PageMemory(page_id, true), page_data, BUSTUB_PAGE_SIZE);
+  WaitUntil(Schedule(page_id, 1, true));
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
-  int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
-  memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
+  CopyOut(page_id, page_data);
+  WaitUntil(Schedule(page_id, 1, false));
+}
+
+auto DiskManagerMemory::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  memcpy(PageMemory(page_id, true), page_data, BUSTUB_PAGE_SIZE);
+  return FutureAt(Schedule(page_id, 1, true));
+}
+
+auto DiskManagerMemory::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  CopyOut(page_id, page_data);
+  return FutureAt(Schedule(page_id, 1, false));
+}
+
+void DiskManagerMemory::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  Clock::time_point done = Clock::now();
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first == pages[end - 1].first + 1) {
+      end++;
+    }
+    for (size_t i = begin; i < end; i++) {
+      memcpy(PageMemory(pages[i].first, true), pages[i].second, BUSTUB_PAGE_SIZE);
+    }
+    done = std::max(done, Schedule(pages[begin].first, end - begin, true));
+    begin = end;
+  }
+  WaitUntil(done);
+}
+
+void DiskManagerMemory::ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  Clock::time_point done = Clock::now();
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first == pages[end - 1].first + 1) {
+      end++;
+    }
+    for (size_t i = begin; i < end; i++) {
+      CopyOut(pages[i].first, pages[i].second);
+    }
+    done = std::max(done, Schedule(pages[begin].first, end - begin, false));
+    begin = end;
+  }
+  WaitUntil(done);
+}
+
+void DiskManagerMemory::SyncPages() {
+  num_syncs_ += 1;
+  if (model_.IsNone()) {
+    return;
+  }
+  Clock::time_point done;
+  {
+    std::scoped_lock lock(device_latch_);
+    done = std::max(Clock::now(), last_done_) + model_.sync_latency_;
+    // Nothing else is served while the device syncs.
+    last_done_ = done;
+    transfer_end_ = std::max(transfer_end_, done);
+    for (auto &slot : slots_) {
+      slot = done;
+    }
+  }
+  WaitUntil(done);
+}
+
+auto DiskManagerMemory::GetNumChunks() -> size_t {
+  std::shared_lock lock(chunks_latch_);
+  return chunks_.size();
+}
+
+auto DiskManagerMemory::PageMemory(page_id_t page_id, bool create) -> char * {
+  assert(page_id >= 0);
+  const page_id_t chunk = page_id / static_cast<page_id_t>(CHUNK_PAGES);
+  const size_t offset = static_cast<size_t>(page_id) % CHUNK_PAGES * BUSTUB_PAGE_SIZE;
+  {
+    std::shared_lock lock(chunks_latch_);
+    auto it = chunks_.find(chunk);
+    if (it != chunks_.end()) {
+      return it->second.get() + offset;
+    }
+  }
+  if (!create) {
+    return nullptr;
+  }
+  std::scoped_lock lock(chunks_latch_);
+  auto &memory = chunks_[chunk];
+  if (memory == nullptr) {
+    // zero-filled, so that the other pages of the chunk read as never written
+    memory = std::make_unique<char[]>(CHUNK_PAGES * BUSTUB_PAGE_SIZE);
+  }
+  return memory.get() + offset;
+}
+
+void DiskManagerMemory::CopyOut(page_id_t page_id, char *page_data) {
+  const char *memory = PageMemory(page_id, false);
+  if (memory == nullptr) {
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+  } else {
+    memcpy(page_data, memory, BUSTUB_PAGE_SIZE);
+  }
+}
+
+auto DiskManagerMemory::Schedule(page_id_t page_id, size_t num_pages, bool write) -> Clock::time_point {
+  const uint64_t bytes = num_pages * BUSTUB_PAGE_SIZE;
+  num_operations_ += 1;
+  if (write) {
+    num_writes_ += static_cast<int>(num_pages);
+    bytes_written_ += bytes;
+  } else {
+    num_reads_ += num_pages;
+    bytes_read_ += bytes;
+  }
+  const Clock::time_point now = Clock::now();
+  if (model_.IsNone()) {
+    return now;
+  }
+
+  std::scoped_lock lock(device_latch_);
+  // Wait for the queue slot that frees up first.
+  Clock::time_point start = now;
+  auto slot = std::min_element(slots_.begin(), slots_.end());
+  if (slot != slots_.end()) {
+    start = std::max(start, *slot);
+  }
+  std::chrono::nanoseconds access = write ? model_.write_latency_ : model_.read_latency_;
+  if (page_id != next_page_id_) {
+    access += model_.seek_latency_;
+    num_seeks_ += 1;
+  }
+  next_page_id_ = page_id + static_cast<page_id_t>(num_pages);
+  // After the access latency, the bytes go over the device one transfer at a time.
+  Clock::time_point done = start + access;
+  const uint64_t bandwidth = write ? model_.write_bandwidth_ : model_.read_bandwidth_;
+  if (bandwidth != 0) {
+    done = std::max(done, transfer_end_) + std::chrono::nanoseconds(bytes * 1000000000 / bandwidth);
+    transfer_end_ = done;
+  }
+  if (slot != slots_.end()) {
+    *slot = done;
+  }
+  last_done_ = std::max(last_done_, done);
+  queue_wait_nanos_ += (start - now).count();
+  service_nanos_ += (done - start).count();
+  return done;
+}
+
+void DiskManagerMemory::WaitUntil(Clock::time_point done) {
+  // Sleeps overshoot by tens of microseconds, so the last stretch is spun.
+  constexpr auto spin = std::chrono::microseconds(100);
+  if (done - Clock::now() > spin) {
+    std::this_thread::sleep_until(done - spin);
+  }
+  while (Clock::now() < done) {
+    std::this_thread::yield();
+  }
+}
+
+auto DiskManagerMemory::FutureAt(Clock::time_point done) -> std::future<void> {
+  if (done <= Clock::now()) {
+    std::promise<void> ready;
+    ready.set_value();
+    return ready.get_future();
+  }
+  return std::async(std::launch::deferred, [done] { WaitUntil(done); });
 }
 
 }  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+auto FreeSpaceMap::Allocate(page_id_t near_page_id, uint32_t num_instances, uint32_t instance_index) -> page_id_t {
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index out of range");
+  if (cursors_.size() != num_instances) {
+    cursors_.assign(num_instances, 0);
+  }
+  page_id_t page_id = INVALID_PAGE_ID;
+  if (near_page_id != INVALID_PAGE_ID) {
+    page_id = FindFree(AlignUp(near_page_id + 1, num_instances, instance_index), num_instances);
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    auto &cursor = cursors_[instance_index];
+    page_id = FindFree(AlignUp(cursor, num_instances, instance_index), num_instances);
+    if (page_id == INVALID_PAGE_ID) {
+      // Every page id of the instance is in use, grow the map.
+      page_id = AlignUp(end_, num_instances, instance_index);
+    }
+    cursor = page_id + static_cast<page_id_t>(num_instances);
+  }
+  Set(page_id);
+  return page_id;
+}
+
+auto FreeSpaceMap::Deallocate(page_id_t page_id) -> bool {
+  if (!IsAllocated(page_id)) {
+    return false;
+  }
+  bits_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  num_allocated_--;
+  if (!cursors_.empty()) {
+    auto &cursor = cursors_[page_id % cursors_.size()];
+    cursor = std::min(cursor, page_id);
+  }
+  return true;
+}
+
+auto FreeSpaceMap::MarkAllocated(page_id_t page_id) -> bool {
+  if (page_id < 0 || IsAllocated(page_id)) {
+    return false;
+  }
+  Set(page_id);
+  return true;
+}
+
+auto FreeSpaceMap::IsAllocated(page_id_t page_id) const -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id / 64) >= bits_.size()) {
+    return false;
+  }
+  return (bits_[page_id / 64] >> (page_id % 64) & 1) != 0;
+}
+
+void FreeSpaceMap::LoadMapPage(size_t map_page, const char *data) {
+  const size_t first_word = map_page * WORDS_PER_MAP_PAGE;
+  if (bits_.size() < first_word + WORDS_PER_MAP_PAGE) {
+    bits_.resize(first_word + WORDS_PER_MAP_PAGE, 0);
+  }
+  for (size_t i = 0; i < WORDS_PER_MAP_PAGE; i++) {
+    num_allocated_ -= __builtin_popcountll(bits_[first_word + i]);
+  }
+  memcpy(&bits_[first_word], data, BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < WORDS_PER_MAP_PAGE; i++) {
+    const uint64_t word = bits_[first_word + i];
+    num_allocated_ += __builtin_popcountll(word);
+    if (word != 0) {
+      end_ = std::max(end_, static_cast<page_id_t>((first_word + i) * 64 + 64 - __builtin_clzll(word)));
+    }
+  }
+  // The loaded page may have freed ids below the cursors.
+  cursors_.clear();
+}
+
+void FreeSpaceMap::StoreMapPage(size_t map_page, char *data) const {
+  const size_t first_word = map_page * WORDS_PER_MAP_PAGE;
+  if (bits_.size() < first_word + WORDS_PER_MAP_PAGE) {
+    memset(data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  memcpy(data, &bits_[first_word], BUSTUB_PAGE_SIZE);
+}
+
+auto FreeSpaceMap::AlignUp(page_id_t from, uint32_t num_instances, uint32_t instance_index) -> page_id_t {
+  const auto n = static_cast<page_id_t>(num_instances);
+  const auto i = static_cast<page_id_t>(instance_index);
+  const page_id_t base = from - from % n;
+  return base + i >= from ? base + i : base + n + i;
+}
+
+auto FreeSpaceMap::FindFree(page_id_t from, uint32_t num_instances) const -> page_id_t {
+  for (page_id_t page_id = from; page_id < end_; page_id += static_cast<page_id_t>(num_instances)) {
+    const uint64_t word = bits_[page_id / 64];
+    // With a single instance every page id counts, so whole words of allocated ids can be skipped at once.
+    if (num_instances == 1 && word == UINT64_MAX) {
+      page_id = page_id - page_id % 64 + 63;
+      continue;
+    }
+    if ((word >> (page_id % 64) & 1) == 0) {
+      return page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::Set(page_id_t page_id) {
+  const auto word = static_cast<size_t>(page_id / 64);
+  if (word >= bits_.size()) {
+    bits_.resize((MapPageOf(page_id) + 1) * WORDS_PER_MAP_PAGE, 0);
+  }
+  bits_[word] |= uint64_t{1} << (page_id % 64);
+  num_allocated_++;
+  end_ = std::max(end_, page_id + 1);
+}
+
+}  // namespace bustub
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/storage/disk/page_codec.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** A token holds the literal length and the match length in a nibble each; this value means more length follows. */
+constexpr size_t NIBBLE_MAX = 15;
+/** References are stored in two bytes. */
+constexpr size_t MAX_OFFSET = 65535;
+constexpr size_t HASH_BITS = 12;
+
+auto Load32(const uint8_t *p) -> uint32_t {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t sequence) -> size_t { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Write the part of a length that does not fit into its nibble: bytes of 255, then the remainder. */
+auto WriteLength(uint8_t *out, size_t op, size_t length) -> size_t {
+  while (length >= 255) {
+    out[op++] = 255;
+    length -= 255;
+  }
+  out[op++] = static_cast<uint8_t>(length);
+  return op;
+}
+
+/** Read the rest of a length written by WriteLength and add it to length. */
+auto ReadLength(const uint8_t *in, size_t size, size_t *ip, size_t *length) -> bool {
+  while (true) {
+    if (*ip >= size) {
+      return false;
+    }
+    const uint8_t byte = in[(*ip)++];
+    *length += byte;
+    if (byte != 255) {
+      return true;
+    }
+  }
+}
+
+/** Write a sequence: the literals, then a reference of match_length bytes, or no reference if match_length is 0. */
+auto WriteSequence(uint8_t *out, size_t op, const uint8_t *literals, size_t num_literals, size_t offset,
+                   size_t match_length) -> size_t {
+  const size_t match_code = match_length == 0 ? 0 : match_length - PageCodec::MIN_MATCH;
+  out[op++] = static_cast<uint8_t>(std::min(num_literals, NIBBLE_MAX) << 4 | std::min(match_code, NIBBLE_MAX));
+  if (num_literals >= NIBBLE_MAX) {
+    op = WriteLength(out, op, num_literals - NIBBLE_MAX);
+  }
+  std::memcpy(out + op, literals, num_literals);
+  op += num_literals;
+  if (match_length == 0) {
+    return op;
+  }
+  out[op++] = static_cast<uint8_t>(offset & 0xff);
+  out[op++] = static_cast<uint8_t>(offset >> 8);
+  if (match_code >= NIBBLE_MAX) {
+    op = WriteLength(out, op, match_code - NIBBLE_MAX);
+  }
+  return op;
+}
+
+}  // namespace
+
+auto PageCodec::Compress(const char *src, size_t size, char *dst) -> size_t {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  // Position + 1 of the last occurrence of each hash, 0 if there was none.
+  std::array<uint32_t, 1 << HASH_BITS> table{};
+  size_t op = 0;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    const uint32_t sequence = Load32(in + pos);
+    const size_t hash = Hash(sequence);
+    const size_t candidate = table[hash];
+    table[hash] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Load32(in + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    const size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && in[match + length] == in[pos + length]) {
+      length++;
+    }
+    op = WriteSequence(out, op, in + anchor, pos - anchor, pos - match, length);
+    pos += length;
+    anchor = pos;
+  }
+  // The last sequence has only literals, possibly none.
+  return WriteSequence(out, op, in + anchor, size - anchor, 0, 0);
+}
+
+auto PageCodec::Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  size_t ip = 0;
+  size_t op = 0;
+  while (true) {
+    if (ip >= size) {
+      return false;
+    }
+    const uint8_t token = in[ip++];
+    size_t num_literals = token >> 4;
+    if (num_literals == NIBBLE_MAX && !ReadLength(in, size, &ip, &num_literals)) {
+      return false;
+    }
+    if (num_literals > size - ip || num_literals > dst_size - op) {
+      return false;
+    }
+    std::memcpy(out + op, in + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    if (ip == size) {
+      return op == dst_size;
+    }
+
+    if (size - ip < 2) {
+      return false;
+    }
+    const size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+    ip += 2;
+    size_t length = token & NIBBLE_MAX;
+    if (length == NIBBLE_MAX && !ReadLength(in, size, &ip, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > op || length > dst_size - op) {
+      return false;
+    }
+    // Byte by byte, the reference may overlap the bytes it produces.
+    for (size_t i = 0; i < length; i++) {
+      out[op + i] = out[op + i - offset];
+    }
+    op += length;
+  }
+}
+
+}  // namespace bustub
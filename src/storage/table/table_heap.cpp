@@ -27,18 +27,23 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
-  // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  // Initialize the first table page. The table gets a segment of its own if the disk manager has segment files, so that
+  // its pages are not interleaved with those of other tables; the pages that follow are allocated near this one.
+  const segment_id_t segment = buffer_pool_manager_->NewSegment();
+  auto first_page = reinterpret_cast<TablePage *>(
+      segment == DEFAULT_SEGMENT_ID
+          ? buffer_pool_manager_->NewPage(&first_page_id_)
+          : buffer_pool_manager_->NewPageNear(&first_page_id_, DiskManager::SegmentHeaderPageId(segment)));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->WLatch();
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, BUSTUB_PAGE_DATA_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 32 > BUSTUB_PAGE_DATA_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
@@ -63,8 +68,10 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
       cur_page->WLatch();
     } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      // Otherwise we have run out of valid pages. We need to create a new page, right after this one on disk if
+      // possible so that scans of the table read the file sequentially.
+      auto new_page =
+          static_cast<TablePage *>(buffer_pool_manager_->NewPageNear(&next_page_id, cur_page->GetTablePageId()));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -76,7 +83,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       // Otherwise we were able to create a new page. We initialize it now.
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      new_page->Init(next_page_id, BUSTUB_PAGE_DATA_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
       cur_page = new_page;
@@ -154,9 +161,9 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type) -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), access_type));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -176,20 +183,52 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto next_page_id = page->GetNextPageId();
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
+      // The scan starts on this page, get the read of the next one going. TableIterator keeps reading ahead from there.
+      if (next_page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager_->PrefetchPages({next_page_id});
+      }
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
   return {this, rid, txn};
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
+auto TableHeap::Drop() -> bool {
+  const segment_id_t segment = DiskManager::SegmentOf(first_page_id_);
+  // The whole file goes at once, without reading a single page. Without segment files, page ids past the first
+  // segment are in the db file, there is no such segment, and the table is dropped like any other in the db file.
+  if (first_page_id_ != INVALID_PAGE_ID && segment != DEFAULT_SEGMENT_ID &&
+      buffer_pool_manager_->DeleteSegment(segment)) {
+    first_page_id_ = INVALID_PAGE_ID;
+    return true;
+  }
+  // In the db file, the pages are found by following the chain and deleted one by one.
+  while (first_page_id_ != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    if (page == nullptr) {
+      return false;
+    }
+    page->RLatch();
+    const page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    if (!buffer_pool_manager_->DeletePage(first_page_id_)) {
+      return false;
+    }
+    first_page_id_ = next_page_id;
+  }
+  return true;
+}
+
 }  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Load the page into the frame the way the buffer pool does, and unpin it. */
+static void LoadPage(ARCReplacer *replacer, frame_id_t frame_id, page_id_t page_id,
+                     AccessType access_type = AccessType::Unknown) {
+  replacer->SetFramePage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, true);
+}
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    LoadPage(&replacer, frame_id, 100 + frame_id);
+  }
+  EXPECT_EQ(4, replacer.Size());
+  EXPECT_EQ(0, replacer.GetTarget());
+
+  // Scenario: every page was seen once, so the least recently used page of T1 goes first and is remembered in B1.
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: a second access moves frame 1 to T2. Page 100 comes back while it is in B1, which moves it to T2 as
+  // well and makes T1 a bit larger.
+  replacer.RecordAccess(1);
+  LoadPage(&replacer, 0, 100);
+  EXPECT_EQ(1, replacer.GetTarget());
+  std::vector<frame_id_t> expected{2, 3, 1, 0};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(4));
+
+  // Scenario: T1 is over its target of one frame, so it gives up a frame; then T2 does.
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: page 101 comes back while it is in B2, which shrinks the target of T1 again.
+  LoadPage(&replacer, 1, 101);
+  EXPECT_EQ(0, replacer.GetTarget());
+  expected = {3, 0, 1};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(4));
+}
+
+TEST(ARCReplacerTest, ScanAccessTest) {
+  ARCReplacer replacer(4);
+
+  // Scenario: frame 1 was only scanned, so it is evicted before the older frame 0 and leaves no trace in B1.
+  LoadPage(&replacer, 0, 100);
+  LoadPage(&replacer, 1, 101, AccessType::Scan);
+  replacer.RecordAccess(0, AccessType::Scan);
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  LoadPage(&replacer, 1, 101);
+  EXPECT_EQ(0, replacer.GetTarget());
+
+  // Scenario: a pinned frame is not a candidate, and removing a frame forgets its page.
+  replacer.SetEvictable(0, false);
+  EXPECT_EQ(1, replacer.Size());
+  replacer.Remove(1);
+  EXPECT_EQ(0, replacer.Size());
+  EXPECT_FALSE(replacer.Evict(&value));
+}
+
+}  // namespace bustub
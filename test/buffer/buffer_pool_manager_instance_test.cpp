@@ -12,12 +12,18 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
 #include <cstdio>
+#include <fstream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/page/header_page.h"
 
 namespace bustub {
 
@@ -145,4 +151,782 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const int num_pages = 32;
+  const int num_threads = 8;
+  const int rounds = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // All threads walk over the same pages, which are four times as many as there are frames. Threads regularly miss on
+  // the same page at once, or fetch a page while its dirty frame is still being written back; every fetch must still
+  // see the data that was written, and no page may end up in two frames.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, tid] {
+      for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < num_pages; i++) {
+          page_id_t page_id = (i + tid) % num_pages;
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            // Every frame is pinned by the other threads right now.
+            continue;
+          }
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+          EXPECT_TRUE(bpm->UnpinPage(page_id, round % 2 == 0));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: a workload that keeps creating and deleting pages, resident or evicted, does not grow the file.
+  std::vector<page_id_t> live;
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 20; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_LT(page_id, 40);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      live.push_back(page_id);
+    }
+    while (live.size() > 20) {
+      EXPECT_TRUE(bpm->DeletePage(live.front()));
+      live.erase(live.begin());
+    }
+  }
+  EXPECT_EQ(20, disk_manager->GetNumAllocatedPages());
+  // A pinned page cannot be deleted.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_FALSE(bpm->DeletePage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->DeletePage(page_id));
+
+  // Scenario: the surviving pages kept their data.
+  for (auto live_page_id : live) {
+    auto *live_page = bpm->FetchPage(live_page_id);
+    ASSERT_NE(nullptr, live_page);
+    EXPECT_EQ(std::to_string(live_page_id), std::string(live_page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(live_page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeleteSegmentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name, false, false, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: the pages of a segment are allocated one after the other in its file, some stay resident.
+  auto segment = bpm->NewSegment();
+  ASSERT_EQ(1, segment);
+  std::vector<page_id_t> page_ids;
+  page_id_t near_page_id = DiskManager::SegmentHeaderPageId(segment);
+  for (int i = 0; i < 8; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPageNear(&page_id, near_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(near_page_id + 1, page_id);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+    near_page_id = page_id;
+  }
+  page_id_t other_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&other_page_id));
+  EXPECT_EQ(DEFAULT_SEGMENT_ID, DiskManager::SegmentOf(other_page_id));
+  snprintf(bpm->FetchPage(other_page_id)->GetData(), BUSTUB_PAGE_SIZE, "other");
+  EXPECT_TRUE(bpm->UnpinPage(other_page_id, true));
+
+  // Scenario: a pinned page of the segment keeps it from being deleted.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids.back()));
+  EXPECT_FALSE(bpm->DeleteSegment(segment));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids.back(), false));
+  EXPECT_FALSE(bpm->DeleteSegment(DEFAULT_SEGMENT_ID));
+
+  // Scenario: the segment goes with all its pages, resident ones too; the rest of the pool is left alone.
+  EXPECT_TRUE(bpm->DeleteSegment(segment));
+  EXPECT_FALSE(disk_manager->HasSegment(segment));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(page_ids.back()));
+  auto *other_page = bpm->FetchPage(other_page_id);
+  ASSERT_NE(nullptr, other_page);
+  EXPECT_EQ("other", std::string(other_page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(other_page_id, false));
+
+  // Scenario: a new segment in the same slot does not see the pages of the old one.
+  ASSERT_EQ(segment, bpm->NewSegment());
+  page_id_t page_id;
+  auto *page = bpm->NewPageNear(&page_id, DiskManager::SegmentHeaderPageId(segment));
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page_ids.front(), page_id);
+  EXPECT_EQ("", std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  page = bpm->FetchPage(page_ids.back());
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("", std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids.back(), false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.db.1");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t max_pool_size = 40;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, ReplacementPolicy::LRU_K,
+                                            max_pool_size);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: growing the pool makes room for more pages while the old ones stay pinned.
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_TRUE(bpm->Resize(2 * buffer_pool_size));
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: shrinking waits for the pinned pages in the frames that go away, and writes back the dirty ones.
+  const page_id_t pinned_page_id = page_ids.back();
+  for (auto id : page_ids) {
+    if (id != pinned_page_id) {
+      EXPECT_TRUE(bpm->UnpinPage(id, true));
+      // Half of the pages are clean by the time the pool shrinks.
+      if (id % 2 == 1) {
+        EXPECT_TRUE(bpm->FlushPage(id));
+      }
+    }
+  }
+  std::atomic<bool> resized{false};
+  std::thread resizer([&] {
+    EXPECT_TRUE(bpm->Resize(buffer_pool_size / 2));
+    resized = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(resized);
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetPoolSize());
+  EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, true));
+  resizer.join();
+  EXPECT_TRUE(resized);
+  for (size_t i = buffer_pool_size / 2; i < max_pool_size; i++) {
+    EXPECT_EQ(INVALID_PAGE_ID, bpm->GetPages()[i].GetPageId());
+  }
+
+  // Scenario: the smaller pool holds fewer pages, and every page made it through the shrink.
+  std::vector<Page *> pinned;
+  for (size_t i = 0; i < buffer_pool_size / 2; i++) {
+    pinned.push_back(bpm->FetchPage(page_ids[i]));
+    ASSERT_NE(nullptr, pinned.back());
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids.back()));
+  for (size_t i = 0; i < buffer_pool_size / 2; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  for (auto id : page_ids) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 64;
+  const int num_threads = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(32, disk_manager, k, nullptr, ReplacementPolicy::LRU_K, 64);
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: queries keep fetching and dirtying pages while the pool grows and shrinks underneath them.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      while (!stop.load()) {
+        const page_id_t page_id = dist(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        ASSERT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, page_id % 3 == 0));
+      }
+    });
+  }
+  for (int round = 0; round < 50; round++) {
+    EXPECT_TRUE(bpm->Resize(round % 2 == 0 ? 8 : 64));
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(64, bpm->GetPoolSize());
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  // Page data starts after the page header that holds the LSN.
+  const size_t data_offset = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, log_manager);
+
+  // Fill the pool with dirty pages whose log records are not persistent yet.
+  enable_logging = true;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData() + data_offset, BUSTUB_PAGE_SIZE - data_offset, "%d", page_id);
+    page->SetLSN(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: The cleaner must not write a page before its log records are on disk.
+  bpm->StartPageCleaner(1.0, std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0, bpm->GetBackgroundWritebacks());
+
+  // Scenario: Once the log is persistent, the cleaner writes back every dirty page.
+  log_manager->SetPersistentLSN(buffer_pool_size);
+  for (int i = 0; i < 1000 && bpm->GetBackgroundWritebacks() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWritebacks());
+  bpm->StopPageCleaner();
+  enable_logging = false;
+
+  // Scenario: Evicting the cleaned pages does not need any foreground write back, and the data made it to disk.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWritebacks());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData() + data_offset));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushUnloggedPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, log_manager);
+  enable_logging = true;
+
+  // A dirty page whose log record is not persistent yet.
+  LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+  const lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  page->SetLSN(lsn);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // A dirty page that is not logged: the header page keeps the first characters of a table name at OFFSET_LSN, which
+  // read as an LSN far past any that was handed out.
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->NewPage(&page_id));
+  ASSERT_NE(nullptr, header_page);
+  header_page->Init();
+  EXPECT_TRUE(header_page->InsertRecord("test_table", 1));
+  EXPECT_GE(header_page->GetLSN(), log_manager->GetNextLSN());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: Flushing both in one batch flushes the log up to the logged page first.
+  EXPECT_LT(log_manager->GetPersistentLSN(), lsn);
+  bpm->FlushAllPages();
+  EXPECT_EQ(lsn, log_manager->GetPersistentLSN());
+  enable_logging = false;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const int num_pages = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: Pages {0, 1} were evicted by the later pages. Prefetching reads them in without pinning them; resident
+  // pages and invalid page ids are skipped.
+  bpm->PrefetchPages({0, 1, num_pages - 1, INVALID_PAGE_ID});
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ("0", std::string(page0->GetData()));
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(bpm->UnpinPage(0, false));
+
+  auto *page1 = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ("1", std::string(page1->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  EXPECT_EQ(2, bpm->GetNumPrefetches());
+
+  // Scenario: Prefetches never tie up more than a quarter of the pool, so only pages {2, 3} are read ahead here.
+  bpm->PrefetchPages({2, 3, 4, 5, 6, 7});
+  for (int i = 2; i < num_pages / 2; i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(4, bpm->GetNumPrefetches());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const std::string dump_name = "test.bpdump";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const int num_pages = 32;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  bpm->StartPageDumper(dump_name, std::chrono::hours(1));
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Pages {3, 10} are fetched twice and become the hottest evictable pages, page 17 stays pinned.
+  for (page_id_t page_id : {3, 10, 3, 10, 17}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    if (page_id != 17) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: Shutting down dumps the resident pages, pinned ones first, then from the last victim to the next one.
+  delete bpm;
+  std::vector<page_id_t> dumped;
+  {
+    std::ifstream dump(dump_name);
+    page_id_t page_id;
+    while (dump >> page_id) {
+      dumped.push_back(page_id);
+    }
+  }
+  ASSERT_EQ(buffer_pool_size, dumped.size());
+  EXPECT_EQ(17, dumped[0]);
+  EXPECT_EQ(10, dumped[1]);
+  EXPECT_EQ(3, dumped[2]);
+
+  // Scenario: A new pool reads the dumped pages back in the background, and every one of them is a hit afterwards.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(buffer_pool_size, bpm->StartWarmup(dump_name));
+  bpm->WaitForWarmup();
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumWarmedPages());
+
+  // Scenario: The warm pages are ranked like before the restart, so a new page evicts the coldest one of the dump.
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_TRUE(bpm->UnpinPage(new_page_id, false));
+  for (size_t i = 0; i < dumped.size() - 1; i++) {
+    auto *page = bpm->FetchPage(dumped[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(dumped[i]), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(dumped[i], false));
+  }
+  EXPECT_EQ(0, bpm->GetNumMisses(AccessType::Unknown));
+  ASSERT_NE(nullptr, bpm->FetchPage(dumped.back()));
+  EXPECT_TRUE(bpm->UnpinPage(dumped.back(), false));
+  EXPECT_EQ(1, bpm->GetNumMisses(AccessType::Unknown));
+  delete bpm;
+
+  // Scenario: Pages that no longer exist are not read.
+  {
+    std::ofstream dump(dump_name, std::ios::trunc);
+    dump << 1000 << '\n' << -1 << '\n';
+  }
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(0, bpm->StartWarmup(dump_name));
+  EXPECT_EQ(0, bpm->StartWarmup("no_such_file.bpdump"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(dump_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CompressedCacheTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+  const int num_pages = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, ReplacementPolicy::LRU_K, 0,
+                                            1024 * 1024);
+  auto *cache = bpm->GetCompressedCache();
+  ASSERT_NE(nullptr, cache);
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Scenario: Every page the pool dropped went to the cache, dirty ones after they were written back.
+  EXPECT_EQ(num_pages - buffer_pool_size, cache->GetNumPages());
+
+  // Scenario: Misses on the dropped pages are served by the cache.
+  for (int i = 0; i < num_pages - static_cast<int>(buffer_pool_size); i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_pages - buffer_pool_size, cache->GetNumHits());
+  EXPECT_EQ(0, cache->GetNumMisses());
+
+  // Scenario: A page modified after it came out of the cache is not read back in its old version.
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "modified");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  for (int i = 1; i <= static_cast<int>(buffer_pool_size); i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(num_pages - i));
+    EXPECT_TRUE(bpm->UnpinPage(num_pages - i, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ("modified", std::string(page0->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  // Scenario: A deleted page is dropped from the cache as well, its id comes back as an empty page.
+  ASSERT_NE(nullptr, bpm->FetchPage(num_pages - 1));
+  EXPECT_TRUE(bpm->UnpinPage(num_pages - 1, false));
+  EXPECT_TRUE(bpm->DeletePage(1));
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page_id);
+  EXPECT_EQ("", std::string(page->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_GT(cache->GetCompressNanos(), 0);
+  EXPECT_GT(cache->GetDecompressNanos(), 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, ReplacementPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  const int num_pages = 32;
+
+  for (auto policy : {ReplacementPolicy::LRU, ReplacementPolicy::LRU_K, ReplacementPolicy::CLOCK,
+                      ReplacementPolicy::TWO_Q, ReplacementPolicy::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, policy);
+
+    // Scenario: Four times as many pages as frames go through the pool; every page keeps its data.
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    for (int i = 0; i < 4 * num_pages; i++) {
+      auto page_id = dist(gen);
+      auto *page = bpm->FetchPage(page_id, i % 2 == 0 ? AccessType::Lookup : AccessType::Scan);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: Pinned pages are never evicted, whatever the policy.
+    std::vector<page_id_t> pinned;
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      pinned.push_back(page_id);
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(nullptr, bpm->FetchPage(num_pages - 1));
+    for (auto pinned_page_id : pinned) {
+      EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerInstanceTest, HitStressTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t k = 2;
+  const int num_threads = 8;
+  const int num_ops = 20000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: Every page is resident, so all these fetches are hits and none of them takes the buffer pool latch.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (int i = 0; i < num_ops; i++) {
+        auto page_id = page_ids[dist(gen)];
+        auto *page = bpm->FetchPage(page_id, AccessType::Lookup);
+        ASSERT_NE(nullptr, page);
+        page->RLatch();
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 8 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_ops, bpm->GetNumHits(AccessType::Lookup));
+  EXPECT_EQ(0, bpm->GetNumMisses(AccessType::Lookup));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  // Scenario: All pins were dropped, so every frame can be reused for new pages.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, HitMissStressTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+  const int num_pages = 64;
+  const int num_threads = 8;
+  const int num_ops = 5000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: Hits race with evictions of the same frames. A fetch must always get the page it asked for, and every
+  // pin must be dropped in the end.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      // Half the fetches go to a few hot pages, so that hits and misses are both common.
+      std::uniform_int_distribution<page_id_t> hot(0, 3);
+      std::uniform_int_distribution<page_id_t> any(0, num_pages - 1);
+      for (int i = 0; i < num_ops; i++) {
+        auto page_id = i % 2 == 0 ? hot(gen) : any(gen);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_id, page->GetPageId());
+        page->RLatch();
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 4 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
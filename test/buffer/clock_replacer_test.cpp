@@ -19,44 +19,69 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  // Scenario: access six frames and make them evictable. Frame 1 is accessed twice.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+  clock_replacer.RecordAccess(1);
   EXPECT_EQ(6, clock_replacer.Size());
 
-  // Scenario: get three victims from the clock.
+  // Scenario: get three victims from the clock. Every reference bit is set, so the first turn of the hand clears
+  // them all and the second turn evicts in clock order.
   int value;
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(3, value);
 
   // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  // Note that 3 has already been evicted, so pinning 3 should have no effect.
+  clock_replacer.SetEvictable(3, false);
+  clock_replacer.SetEvictable(4, false);
   EXPECT_EQ(2, clock_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
+  // Scenario: access and unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.RecordAccess(4);
+  clock_replacer.SetEvictable(4, true);
 
   // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(4, value);
+  EXPECT_EQ(0, clock_replacer.Size());
+  EXPECT_FALSE(clock_replacer.Evict(&value));
+}
+
+TEST(ClockReplacerTest, ScanAccessTest) {
+  ClockReplacer clock_replacer(4);
+
+  // Scenario: frames 0 and 1 are accessed normally, frames 2 and 3 only by a scan, so their bits stay clear. A scan
+  // access to frame 0 does not change its bit either.
+  clock_replacer.RecordAccess(0);
+  clock_replacer.RecordAccess(1);
+  clock_replacer.RecordAccess(2, AccessType::Scan);
+  clock_replacer.RecordAccess(3, AccessType::Scan);
+  clock_replacer.RecordAccess(0, AccessType::Scan);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+
+  std::vector<frame_id_t> expected{2, 3, 0, 1};
+  EXPECT_EQ(expected, clock_replacer.EvictionCandidates(4));
+  int value;
+  for (auto frame_id : expected) {
+    ASSERT_TRUE(clock_replacer.Evict(&value));
+    EXPECT_EQ(frame_id, value);
+  }
 }
 
 }  // namespace bustub
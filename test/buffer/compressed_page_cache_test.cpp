@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  CompressedPageCache cache(1024);
+  char page[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE];
+
+  // Scenario: A page comes back from the cache once, then it is gone.
+  snprintf(page, sizeof(page), "page %d", 1);
+  EXPECT_TRUE(cache.Insert(1, page));
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_GT(cache.GetSize(), 0);
+  EXPECT_TRUE(cache.Lookup(1, buf));
+  EXPECT_EQ(0, std::memcmp(page, buf, sizeof(page)));
+  EXPECT_FALSE(cache.Lookup(1, buf));
+  EXPECT_EQ(0, cache.GetSize());
+  EXPECT_EQ(1, cache.GetNumHits());
+  EXPECT_EQ(1, cache.GetNumMisses());
+
+  // Scenario: A page that does not compress is not kept.
+  std::mt19937 gen(42);
+  char random_page[BUSTUB_PAGE_SIZE];
+  for (auto &c : random_page) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_FALSE(cache.Insert(2, random_page));
+  EXPECT_EQ(1, cache.GetNumRejections());
+  EXPECT_FALSE(cache.Lookup(2, buf));
+
+  // Scenario: A newer copy replaces the older one, and Erase drops a page.
+  EXPECT_TRUE(cache.Insert(3, page));
+  snprintf(page, sizeof(page), "page %d, again", 3);
+  EXPECT_TRUE(cache.Insert(3, page));
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_TRUE(cache.Lookup(3, buf));
+  EXPECT_EQ(std::string("page 3, again"), std::string(buf));
+  EXPECT_TRUE(cache.Insert(3, page));
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Lookup(3, buf));
+  EXPECT_GT(cache.GetCompressNanos(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CapacityTest) {
+  char page[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE];
+  // Every page compresses to the same size, find out which.
+  size_t page_size;
+  {
+    CompressedPageCache probe(BUSTUB_PAGE_SIZE);
+    snprintf(page, sizeof(page), "page %04d", 0);
+    probe.Insert(0, page);
+    page_size = probe.GetSize();
+  }
+
+  // Scenario: A full cache drops the page that was inserted first.
+  CompressedPageCache cache(4 * page_size);
+  for (page_id_t page_id = 0; page_id < 6; page_id++) {
+    snprintf(page, sizeof(page), "page %04d", page_id);
+    EXPECT_TRUE(cache.Insert(page_id, page));
+  }
+  EXPECT_EQ(4, cache.GetNumPages());
+  EXPECT_EQ(2, cache.GetNumEvictions());
+  EXPECT_LE(cache.GetSize(), 4 * page_size);
+  EXPECT_FALSE(cache.Lookup(0, buf));
+  EXPECT_FALSE(cache.Lookup(1, buf));
+  for (page_id_t page_id = 2; page_id < 6; page_id++) {
+    ASSERT_TRUE(cache.Lookup(page_id, buf));
+    EXPECT_EQ("page 000" + std::to_string(page_id), std::string(buf));
+  }
+}
+
+}  // namespace bustub
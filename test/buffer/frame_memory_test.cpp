@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_memory_test.cpp
+//
+// Identification: test/buffer/frame_memory_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_memory.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(FrameMemoryTest, SampleTest) {
+  // Scenario: a small pool uses regular pages, a pool of at least one huge page asks for huge pages.
+  for (size_t num_frames : {size_t{10}, FrameMemory::HUGE_PAGE_SIZE / BUSTUB_PAGE_SIZE * 3 + 1}) {
+    FrameMemory memory(num_frames);
+    EXPECT_GE(memory.GetSize(), num_frames * BUSTUB_PAGE_SIZE);
+    if (num_frames * BUSTUB_PAGE_SIZE < FrameMemory::HUGE_PAGE_SIZE) {
+      EXPECT_EQ(HugePageMode::NONE, memory.GetHugePageMode());
+    } else {
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(memory.FrameData(0)) % FrameMemory::HUGE_PAGE_SIZE);
+    }
+    // Every frame is aligned for direct I/O, zeroed, and does not overlap its neighbours.
+    for (size_t i = 0; i < num_frames; i++) {
+      char *data = memory.FrameData(static_cast<frame_id_t>(i));
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(data) % DiskManager::DIRECT_IO_ALIGNMENT);
+      ASSERT_EQ(0, data[0]);
+      ASSERT_EQ(0, data[BUSTUB_PAGE_SIZE - 1]);
+      std::memset(data, static_cast<char>(i), BUSTUB_PAGE_SIZE);
+    }
+    for (size_t i = 0; i < num_frames; i++) {
+      char *data = memory.FrameData(static_cast<frame_id_t>(i));
+      ASSERT_EQ(static_cast<char>(i), data[0]);
+      ASSERT_EQ(static_cast<char>(i), data[BUSTUB_PAGE_SIZE - 1]);
+    }
+  }
+}
+
+TEST(FrameMemoryTest, DirectIoBufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 50;
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // The pages of the pool live in page-aligned frames, so they go to disk without a bounce buffer.
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DiskManager::DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -97,4 +97,92 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+TEST(LRUKReplacerTest, ScanAccessTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: frames 1 and 2 are hot, frame 3 has been seen once.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3);
+  for (frame_id_t frame_id = 1; frame_id <= 3; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: a scan brings in frames 4 and 5 and reads frame 1 again. The scanned frames go to the cold end, even in
+  // front of frame 3, and frame 1 does not gain any history. The order of eviction is [4,5,3,1,2].
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.SetEvictable(4, true);
+  lru_replacer.SetEvictable(5, true);
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // Scenario: a regular access to a scanned frame counts as usual. Frame 4 now has two accesses, the older of them
+  // more recent than the second to last access of frames 1 and 2. The order of eviction is [5,3,1,2,4].
+  lru_replacer.RecordAccess(4);
+  int value;
+  for (frame_id_t expected : {5, 3, 1, 2, 4}) {
+    lru_replacer.Evict(&value);
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_replacer(4, 3);
+
+  // Scenario: frame 0 is accessed at timestamps 0, 4, 5 and frame 1 at 1, 2, 3. Frame 0 was accessed last, but its
+  // 3rd most recent access is older than that of frame 1, so its backward k-distance is larger.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(0);
+  // Frames 2 and 3 have fewer than k accesses and go first, the one with the earliest access first.
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: a fourth access to frame 0 drops its oldest access; its 3rd most recent access is now at 4, after 1.
+  lru_replacer.RecordAccess(0);
+  int value;
+  for (frame_id_t expected : {3, 2, 1, 0}) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ResizeTest) {
+  LRUKReplacer lru_replacer(4, 2);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: after growing, the new frames can be tracked, and the history of the old ones is kept.
+  lru_replacer.Resize(8);
+  lru_replacer.RecordAccess(7);
+  lru_replacer.SetEvictable(7, true);
+  ASSERT_EQ(5, lru_replacer.Size());
+  int value;
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: the frames that go away when shrinking are no longer tracked; the rest stays as it was.
+  lru_replacer.Remove(7);
+  lru_replacer.Remove(3);
+  lru_replacer.Resize(3);
+  ASSERT_EQ(2, lru_replacer.Size());
+  for (frame_id_t expected : {1, 2}) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+}
 }  // namespace bustub
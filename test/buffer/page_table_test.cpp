@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(64);
+
+  for (int i = 0; i < 64; i++) {
+    page_table.Insert(i, i + 100);
+  }
+  EXPECT_EQ(64, page_table.Size());
+  frame_id_t frame_id;
+  for (int i = 0; i < 64; i++) {
+    ASSERT_TRUE(page_table.Find(i, frame_id));
+    EXPECT_EQ(i + 100, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(64, frame_id));
+
+  // Scenario: inserting a page that is already there moves it to the new frame.
+  page_table.Insert(7, 1);
+  EXPECT_EQ(64, page_table.Size());
+  ASSERT_TRUE(page_table.Find(7, frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: removing every other page leaves the rest reachable, whatever got shifted around.
+  for (int i = 0; i < 64; i += 2) {
+    EXPECT_TRUE(page_table.Remove(i));
+  }
+  EXPECT_FALSE(page_table.Remove(0));
+  EXPECT_EQ(32, page_table.Size());
+  for (int i = 0; i < 64; i++) {
+    EXPECT_EQ(i % 2 == 1, page_table.Find(i, frame_id));
+  }
+
+  // Scenario: the table keeps working as pages come and go, as they do in a buffer pool.
+  for (int i = 0; i < 64; i += 2) {
+    page_table.Insert(i, i % 64);
+  }
+  for (int i = 64; i < 10000; i++) {
+    EXPECT_TRUE(page_table.Remove(i - 64));
+    page_table.Insert(i, i % 64);
+    ASSERT_TRUE(page_table.Find(i, frame_id));
+    EXPECT_EQ(i % 64, frame_id);
+    ASSERT_TRUE(page_table.Find(i - 63, frame_id));
+  }
+  EXPECT_EQ(64, page_table.Size());
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const int num_stable = 256;
+  const int num_readers = 4;
+  PageTable page_table(2 * num_stable);
+
+  // Pages [0, num_stable) stay in the table the whole time, while a writer keeps inserting and removing other pages
+  // in between them. Removing pages shifts the stable ones around; readers must still find every one of them.
+  for (int i = 0; i < num_stable; i++) {
+    page_table.Insert(i * 2, i);
+  }
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        for (int i = 0; i < num_stable; i++) {
+          frame_id_t frame_id = -1;
+          ASSERT_TRUE(page_table.Find(i * 2, frame_id));
+          ASSERT_EQ(i, frame_id);
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 200; round++) {
+    for (int i = 0; i < num_stable; i++) {
+      page_table.Insert(i * 2 + 1, i);
+    }
+    for (int i = 0; i < num_stable; i++) {
+      EXPECT_TRUE(page_table.Remove(i * 2 + 1));
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_stable, page_table.Size());
+}
+
+TEST(PageTableTest, ReserveTest) {
+  const int num_pages = 1024;
+  const int num_readers = 4;
+  PageTable page_table(16);
+  for (int i = 0; i < 16; i++) {
+    page_table.Insert(i, i);
+  }
+
+  // Scenario: the table grows while readers look up the pages that are in it; none of them goes missing.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        for (int i = 0; i < 16; i++) {
+          frame_id_t frame_id = -1;
+          ASSERT_TRUE(page_table.Find(i, frame_id));
+          ASSERT_EQ(i, frame_id);
+        }
+      }
+    });
+  }
+  for (int max_entries = 32; max_entries <= num_pages; max_entries *= 2) {
+    page_table.Reserve(max_entries);
+    for (int i = max_entries / 2; i < max_entries; i++) {
+      page_table.Insert(i, i);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_pages, page_table.Size());
+  for (int i = 0; i < num_pages; i++) {
+    frame_id_t frame_id = -1;
+    ASSERT_TRUE(page_table.Find(i, frame_id));
+    ASSERT_EQ(i, frame_id);
+  }
+  // Reserving less than there is room for does nothing.
+  page_table.Reserve(16);
+  EXPECT_TRUE(page_table.Remove(0));
+  EXPECT_EQ(num_pages - 1, page_table.Size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer_test.cpp
+//
+// Identification: test/buffer/two_q_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Load the page into the frame the way the buffer pool does, and unpin it. */
+static void LoadPage(TwoQReplacer *replacer, frame_id_t frame_id, page_id_t page_id,
+                     AccessType access_type = AccessType::Unknown) {
+  replacer->SetFramePage(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, true);
+}
+
+TEST(TwoQReplacerTest, SampleTest) {
+  // Eight frames: A1in holds two of them, A1out remembers four pages.
+  TwoQReplacer replacer(8);
+
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    LoadPage(&replacer, frame_id, 100 + frame_id);
+  }
+  EXPECT_EQ(4, replacer.Size());
+
+  // Scenario: Am is empty, so the first victim is the head of the A1in FIFO.
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 100 is remembered in A1out, so loading it again puts it straight into Am. Another access to frame 1
+  // does not move it out of its place in A1in.
+  LoadPage(&replacer, 0, 100);
+  replacer.RecordAccess(1);
+  std::vector<frame_id_t> expected{1, 2, 3, 0};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(4));
+
+  // Scenario: A1in is over its share of two frames, so it gives up one more frame; after that Am is evicted from.
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(1, replacer.Size());
+}
+
+TEST(TwoQReplacerTest, ScanAccessTest) {
+  TwoQReplacer replacer(8);
+
+  // Scenario: page 101 is only read by a scan. Both pages pass through A1in, but only page 100 is remembered.
+  LoadPage(&replacer, 0, 100);
+  LoadPage(&replacer, 1, 101, AccessType::Scan);
+  int value;
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: page 101 comes back first, but only page 100 enters Am, which is evicted from while A1in is small.
+  LoadPage(&replacer, 1, 101);
+  LoadPage(&replacer, 0, 100);
+  std::vector<frame_id_t> expected{0, 1};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(2));
+
+  // Scenario: a pinned frame is not a candidate, and removing a frame forgets its page.
+  replacer.SetEvictable(0, false);
+  EXPECT_EQ(1, replacer.Size());
+  replacer.Remove(1);
+  EXPECT_EQ(0, replacer.Size());
+  EXPECT_FALSE(replacer.Evict(&value));
+}
+
+}  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Check values of RFC 3720, appendix B.4, and the usual check value of CRC catalogues.
+  const std::string check = "123456789";
+  EXPECT_EQ(0xe3069283, Crc32c::Compute(check.data(), check.size()));
+  EXPECT_EQ(0xe3069283, Crc32c::ComputeWithTables(check.data(), check.size()));
+
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8a9136aa, Crc32c::Compute(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xff));
+  EXPECT_EQ(0x62a8ab43, Crc32c::Compute(ones.data(), ones.size()));
+  std::vector<char> ascending(32);
+  for (size_t i = 0; i < ascending.size(); i++) {
+    ascending[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x46dd794e, Crc32c::Compute(ascending.data(), ascending.size()));
+
+  EXPECT_EQ(0, Crc32c::Compute(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, ImplementationsAgreeTest) {
+  std::mt19937 gen(0);
+  std::vector<char> data(3 * 4096);
+  for (auto &byte : data) {
+    byte = static_cast<char>(gen());
+  }
+  // Every length up to a few blocks of the three streams, from unaligned starts too.
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t size = 0; size + offset <= data.size(); size += size < 1024 ? 1 : 509) {
+      const char *begin = data.data() + offset;
+      const uint32_t crc = Crc32c::ComputeWithTables(begin, size);
+      ASSERT_EQ(crc, Crc32c::Compute(begin, size)) << "offset " << offset << " size " << size;
+      // Extending a crc gives the crc of the concatenation.
+      const size_t half = size / 2;
+      ASSERT_EQ(crc, Crc32c::Extend(Crc32c::Compute(begin, half), begin + half, size - half));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+
+  /** Append num_records records for the transaction, inserts of tuples of growing size and a commit at the end. */
+  static void AppendRecords(LogManager *log_manager, txn_id_t txn_id, int num_records, std::vector<lsn_t> *lsns) {
+    Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 64}}};
+    lsn_t prev_lsn = INVALID_LSN;
+    for (int i = 0; i < num_records - 1; i++) {
+      Tuple tuple{{ValueFactory::GetVarcharValue(std::string(i % 64, 'x'))}, &schema};
+      LogRecord log_record(txn_id, prev_lsn, LogRecordType::INSERT, RID(txn_id, i), tuple);
+      prev_lsn = log_manager->AppendLogRecord(&log_record);
+      lsns->push_back(prev_lsn);
+    }
+    LogRecord commit(txn_id, prev_lsn, LogRecordType::COMMIT);
+    lsns->push_back(log_manager->AppendLogRecord(&commit));
+  }
+
+  /** Check that the log file holds the records 0 to num_records - 1, back to back and in LSN order. */
+  static void CheckLogFile(int num_records) {
+    std::ifstream log_file("test.log", std::ios::binary);
+    std::vector<char> log((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    size_t offset = 0;
+    lsn_t expected_lsn = 0;
+    while (offset < log.size()) {
+      int32_t size;
+      lsn_t lsn;
+      int32_t type;
+      memcpy(&size, log.data() + offset, sizeof(size));
+      memcpy(&lsn, log.data() + offset + 4, sizeof(lsn));
+      memcpy(&type, log.data() + offset + 16, sizeof(type));
+      ASSERT_EQ(expected_lsn, lsn) << "at offset " << offset;
+      if (static_cast<LogRecordType>(type) == LogRecordType::INSERT) {
+        int32_t tuple_size;
+        memcpy(&tuple_size, log.data() + offset + 20 + sizeof(RID), sizeof(tuple_size));
+        ASSERT_EQ(20 + sizeof(RID) + sizeof(int32_t) + tuple_size, size);
+      } else {
+        ASSERT_EQ(static_cast<int32_t>(LogRecordType::COMMIT), type);
+        ASSERT_EQ(20, size);
+      }
+      offset += size;
+      expected_lsn++;
+    }
+    EXPECT_EQ(log.size(), offset);
+    EXPECT_EQ(num_records, expected_lsn);
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  const int num_threads = 8;
+  const int num_records = 2000;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+
+  // Scenario: concurrent appends fill many buffers, and every record gets its own LSN, in the order of its transaction.
+  std::vector<std::vector<lsn_t>> lsns(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] { AppendRecords(&log_manager, t, num_records, &lsns[t]); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<bool> seen(num_threads * num_records);
+  for (const auto &txn_lsns : lsns) {
+    for (size_t i = 0; i < txn_lsns.size(); i++) {
+      ASSERT_GE(txn_lsns[i], 0);
+      ASSERT_LT(txn_lsns[i], num_threads * num_records);
+      EXPECT_FALSE(seen[txn_lsns[i]]);
+      seen[txn_lsns[i]] = true;
+      if (i > 0) {
+        EXPECT_LT(txn_lsns[i - 1], txn_lsns[i]);
+      }
+    }
+  }
+  EXPECT_EQ(num_threads * num_records, log_manager.GetNextLSN());
+
+  // Scenario: stopping the flush thread writes out the rest, so the log holds every record.
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(num_threads * num_records - 1, log_manager.GetPersistentLSN());
+  EXPECT_GT(disk_manager.GetNumFlushes(), 1);
+  CheckLogFile(num_threads * num_records);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, FlushWithoutFlushThreadTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  std::vector<lsn_t> lsns;
+
+  // Scenario: without a flush thread, the append that fills the buffer flushes it.
+  AppendRecords(&log_manager, 0, 1000, &lsns);
+  EXPECT_GT(disk_manager.GetNumFlushes(), 0);
+  EXPECT_GT(log_manager.GetPersistentLSN(), INVALID_LSN);
+  EXPECT_LT(log_manager.GetPersistentLSN(), 999);
+
+  // Scenario: a flush writes out everything appended before it, and an empty one changes nothing.
+  log_manager.Flush();
+  EXPECT_EQ(999, log_manager.GetPersistentLSN());
+  const int num_flushes = disk_manager.GetNumFlushes();
+  log_manager.Flush();
+  EXPECT_EQ(999, log_manager.GetPersistentLSN());
+  EXPECT_EQ(num_flushes, disk_manager.GetNumFlushes());
+  EXPECT_EQ(1000, log_manager.GetNextLSN());
+  CheckLogFile(1000);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 8;
+  const int num_txns = 50;
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: a commit returns only once its COMMIT record is on disk, and concurrent commits share their flushes.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_txns; i++) {
+        auto *txn = txn_manager.Begin();
+        txn_manager.Commit(txn);
+        EXPECT_NE(INVALID_LSN, txn->GetPrevLSN());
+        EXPECT_LE(txn->GetPrevLSN(), log_manager.GetPersistentLSN());
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // a BEGIN and a COMMIT record for each transaction
+  EXPECT_EQ(2 * num_threads * num_txns, log_manager.GetNextLSN());
+  EXPECT_EQ(2 * num_threads * num_txns - 1, log_manager.GetPersistentLSN());
+  EXPECT_LT(disk_manager.GetNumFlushes(), num_threads * num_txns);
+
+  // Scenario: without the flush thread, a commit flushes by itself.
+  log_manager.StopFlushThread();
+  enable_logging = true;
+  auto *txn = txn_manager.Begin();
+  txn_manager.Commit(txn);
+  EXPECT_EQ(txn->GetPrevLSN(), log_manager.GetPersistentLSN());
+  enable_logging = false;
+  delete txn;
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AsynchronousCommitTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  BufferPoolManagerInstance bpm(10, &disk_manager, LRUK_REPLACER_K, &log_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: an asynchronous commit returns with its COMMIT record still in the log buffer.
+  auto *txn = txn_manager.Begin(nullptr, IsolationLevel::REPEATABLE_READ, false);
+  EXPECT_FALSE(txn->IsSynchronousCommit());
+  txn_manager.Commit(txn);
+  const lsn_t commit_lsn = txn->GetPrevLSN();
+  EXPECT_EQ(TransactionState::COMMITTED, txn->GetState());
+  EXPECT_LT(log_manager.GetPersistentLSN(), commit_lsn);
+  EXPECT_EQ(0, disk_manager.GetNumFlushes());
+
+  // Scenario: a page the transaction changed is not written before the COMMIT record is on disk.
+  page_id_t page_id;
+  auto *page = bpm.NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  page->SetLSN(commit_lsn);
+  bpm.UnpinPage(page_id, true);
+  EXPECT_TRUE(bpm.FlushPage(page_id));
+  EXPECT_GE(log_manager.GetPersistentLSN(), commit_lsn);
+  delete txn;
+
+  // Scenario: a synchronous commit after it makes both durable.
+  txn = txn_manager.Begin();
+  EXPECT_TRUE(txn->IsSynchronousCommit());
+  txn_manager.Commit(txn);
+  EXPECT_EQ(txn->GetPrevLSN(), log_manager.GetPersistentLSN());
+  delete txn;
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE];
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = AsyncDiskManager(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // ReadPage and WritePage wait for their request.
+  dm.WritePage(2, data);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(1, dm.GetNumWrites());
+
+  // Pages past the end of the file and holes before it read as zeros.
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPageAsync(1, buf).get();
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ManyInFlightTest) {
+  // More pages than the queue is deep, so that submitting blocks on completions.
+  const uint32_t queue_depth = 8;
+  const int num_pages = 256;
+  std::string db_file("test.db");
+  auto dm = AsyncDiskManager(db_file, queue_depth);
+
+  std::vector<char> data(num_pages * BUSTUB_PAGE_SIZE);
+  for (int i = 0; i < num_pages; i++) {
+    std::memset(&data[i * BUSTUB_PAGE_SIZE], 'a' + i % 26, BUSTUB_PAGE_SIZE);
+    snprintf(&data[i * BUSTUB_PAGE_SIZE], BUSTUB_PAGE_SIZE, "%d", i);
+  }
+  std::vector<std::future<void>> requests;
+  for (int i = 0; i < num_pages; i++) {
+    requests.push_back(dm.WritePageAsync(i, &data[i * BUSTUB_PAGE_SIZE]));
+  }
+  for (auto &request : requests) {
+    request.get();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Read everything back in reverse, again with all the reads in flight at once.
+  std::vector<char> buf(num_pages * BUSTUB_PAGE_SIZE);
+  requests.clear();
+  for (int i = num_pages - 1; i >= 0; i--) {
+    requests.push_back(dm.ReadPageAsync(i, &buf[i * BUSTUB_PAGE_SIZE]));
+  }
+  for (auto &request : requests) {
+    request.get();
+  }
+  EXPECT_EQ(0, std::memcmp(data.data(), buf.data(), data.size()));
+
+  // The writes made it into the file, not just into the ring.
+  dm.ShutDown();
+  auto sync_dm = DiskManager(db_file);
+  char page[BUSTUB_PAGE_SIZE];
+  sync_dm.ReadPage(num_pages - 1, page);
+  EXPECT_EQ(0, std::memcmp(&data[(num_pages - 1) * BUSTUB_PAGE_SIZE], page, sizeof(page)));
+  sync_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+  const int num_pages = 64;
+  std::string db_file("test.db");
+  auto *disk_manager = new AsyncDiskManager(db_file);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // The page cleaner writes back whole rounds of dirty pages through the ring.
+  bpm->StartPageCleaner(1.0, std::chrono::milliseconds(1));
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->StopPageCleaner();
+
+  // The prefetcher reads its batch through the ring, with the reads in flight together.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 4); page_id++) {
+    page_ids.push_back(page_id);
+  }
+  bpm->PrefetchPages(page_ids);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(buffer_pool_size / 4, bpm->GetNumPrefetches());
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
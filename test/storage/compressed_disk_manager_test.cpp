@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_disk_manager_test.cpp
+//
+// Identification: test/storage/compressed_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/compressed_disk_manager.h"
+
+namespace bustub {
+
+class CompressedDiskManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+
+  /** A page of page_id with mostly zeros, which compresses well. */
+  static auto SparsePage(page_id_t page_id) -> std::vector<char> {
+    std::vector<char> page(BUSTUB_PAGE_SIZE);
+    snprintf(page.data(), page.size(), "page %d", page_id);
+    return page;
+  }
+
+  /** A page of random bytes, which does not compress. */
+  static auto RandomPage(uint32_t seed) -> std::vector<char> {
+    std::vector<char> page(BUSTUB_PAGE_SIZE);
+    std::mt19937 gen(seed);
+    for (auto &byte : page) {
+      byte = static_cast<char>(gen());
+    }
+    return page;
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, ReadWritePageTest) {
+  CompressedDiskManager dm("test.db");
+  std::vector<char> buf(BUSTUB_PAGE_SIZE, 1);
+
+  // A page that was never written reads as zeros.
+  dm.ReadPage(3, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE), buf);
+
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    dm.WritePage(page_id, SparsePage(page_id).data());
+  }
+  auto random = RandomPage(0);
+  dm.WritePage(10, random.data());
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    dm.ReadPage(page_id, buf.data());
+    EXPECT_EQ(SparsePage(page_id), buf);
+  }
+  dm.ReadPage(10, buf.data());
+  EXPECT_EQ(random, buf);
+
+  // The sparse pages take a slot each, the random one is stored as it is.
+  EXPECT_EQ(11, dm.GetNumStoredPages());
+  EXPECT_LT(dm.GetStoredBytes(), 10 * CompressedDiskManager::SLOT_ALIGNMENT + BUSTUB_PAGE_SIZE);
+  EXPECT_EQ((1 + 10 + BUSTUB_PAGE_SIZE / CompressedDiskManager::SLOT_ALIGNMENT) *
+                CompressedDiskManager::SLOT_ALIGNMENT,
+            dm.GetFileEnd());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, RewriteTest) {
+  CompressedDiskManager dm("test.db");
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  dm.WritePage(0, SparsePage(0).data());
+  dm.WritePage(1, SparsePage(1).data());
+  const size_t end = dm.GetFileEnd();
+
+  // The same size goes back into the slot.
+  dm.WritePage(0, SparsePage(100).data());
+  EXPECT_EQ(end, dm.GetFileEnd());
+
+  // A page that grows moves to a new slot, and one that shrinks again takes the space it gave up.
+  auto random = RandomPage(1);
+  dm.WritePage(0, random.data());
+  EXPECT_EQ(end + BUSTUB_PAGE_SIZE, dm.GetFileEnd());
+  dm.WritePage(1, SparsePage(101).data());
+  dm.WritePage(2, SparsePage(2).data());
+  EXPECT_EQ(end + BUSTUB_PAGE_SIZE, dm.GetFileEnd());
+
+  dm.ReadPage(0, buf.data());
+  EXPECT_EQ(random, buf);
+  dm.ReadPage(1, buf.data());
+  EXPECT_EQ(SparsePage(101), buf);
+  dm.ReadPage(2, buf.data());
+  EXPECT_EQ(SparsePage(2), buf);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, PersistenceTest) {
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  auto random = RandomPage(2);
+  {
+    CompressedDiskManager dm("test.db");
+    for (int i = 0; i < 20; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, SparsePage(i).data());
+    }
+    dm.WritePage(7, random.data());
+    dm.DeallocatePage(3);
+    dm.SyncPages();
+    // Written after the checkpoint, the last checkpoint of ~CompressedDiskManager keeps it.
+    dm.WritePage(19, random.data());
+  }
+  {
+    CompressedDiskManager dm("test.db");
+    EXPECT_EQ(19, dm.GetNumAllocatedPages());
+    EXPECT_FALSE(dm.IsPageAllocated(3));
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(19, dm.GetNumStoredPages());
+    for (page_id_t page_id = 0; page_id < 20; page_id++) {
+      dm.ReadPage(page_id, buf.data());
+      if (page_id == 3) {
+        EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE), buf);
+      } else if (page_id == 7 || page_id == 19) {
+        EXPECT_EQ(random, buf);
+      } else {
+        EXPECT_EQ(SparsePage(page_id), buf);
+      }
+    }
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompressedDiskManagerTest, CheckpointKeepsSlotsTest) {
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  CompressedDiskManager dm("test.db");
+  dm.WritePage(0, SparsePage(0).data());
+  dm.SyncPages();
+  const size_t end = dm.GetFileEnd();
+
+  // The slot of page 0 is in the checkpoint, so the rewrite must not go in place; it goes to a new slot.
+  dm.WritePage(0, SparsePage(1000).data());
+  EXPECT_EQ(end + CompressedDiskManager::SLOT_ALIGNMENT, dm.GetFileEnd());
+  dm.ReadPage(0, buf.data());
+  EXPECT_EQ(SparsePage(1000), buf);
+
+  // After the next checkpoint, the old slot and the old checkpoint are free again.
+  dm.SyncPages();
+  const size_t synced_end = dm.GetFileEnd();
+  dm.WritePage(1, SparsePage(1).data());
+  dm.WritePage(2, SparsePage(2).data());
+  EXPECT_EQ(synced_end, dm.GetFileEnd());
+  dm.SyncPages();
+  dm.ShutDown();
+
+  CompressedDiskManager reopened("test.db");
+  for (page_id_t page_id = 1; page_id < 3; page_id++) {
+    reopened.ReadPage(page_id, buf.data());
+    EXPECT_EQ(SparsePage(page_id), buf);
+  }
+  reopened.ReadPage(0, buf.data());
+  EXPECT_EQ(SparsePage(1000), buf);
+  reopened.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory_test.cpp
+//
+// Identification: test/storage/disk_manager_memory_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using std::chrono::milliseconds;
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, SparsePagesTest) {
+  DiskManagerMemory dm;
+  std::vector<char> data(BUSTUB_PAGE_SIZE, 'a');
+  std::vector<char> buf(BUSTUB_PAGE_SIZE, 'b');
+
+  // Page ids far apart, e.g. in different segments, only take the chunks they are in.
+  const page_id_t far_page_id = 3 * DiskManager::PAGES_PER_SEGMENT + 5;
+  dm.WritePage(5, data.data());
+  data[0] = 'z';
+  dm.WritePage(far_page_id, data.data());
+  EXPECT_EQ(2, dm.GetNumChunks());
+
+  dm.ReadPage(5, buf.data());
+  EXPECT_EQ('a', buf[0]);
+  dm.ReadPage(far_page_id, buf.data());
+  EXPECT_EQ('z', buf[0]);
+  // Pages never written read as zeros, in a chunk that exists or not.
+  dm.ReadPage(6, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE), buf);
+  dm.ReadPage(1000, buf.data());
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE), buf);
+  EXPECT_EQ(2, dm.GetNumChunks());
+
+  EXPECT_EQ(4, dm.GetNumReads());
+  EXPECT_EQ(2, dm.GetNumWrites());
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, dm.GetBytesRead());
+  EXPECT_EQ(2 * BUSTUB_PAGE_SIZE, dm.GetBytesWritten());
+  EXPECT_EQ(0, dm.GetServiceTime().count());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, AllocatePastSegmentTest) {
+  DiskManagerMemory dm;
+  // Without segment files, page ids are not split into segments, and allocation goes on past the size of one.
+  page_id_t page_id = INVALID_PAGE_ID;
+  for (page_id_t i = 0; i <= DiskManager::PAGES_PER_SEGMENT; i++) {
+    page_id = dm.AllocatePage();
+  }
+  EXPECT_EQ(DiskManager::PAGES_PER_SEGMENT, page_id);
+  EXPECT_EQ(DiskManager::PAGES_PER_SEGMENT + 1, dm.AllocatePage(page_id));
+  EXPECT_EQ(static_cast<size_t>(DiskManager::PAGES_PER_SEGMENT) + 2, dm.GetNumAllocatedPages());
+
+  // The pages past the first segment are pages of their own, not the ones at their index in it.
+  dm.DeallocatePage(page_id);
+  EXPECT_FALSE(dm.IsPageAllocated(page_id));
+  EXPECT_TRUE(dm.IsPageAllocated(0));
+  EXPECT_EQ(page_id, dm.AllocatePage());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, QueueDepthTest) {
+  std::vector<char> buf(4 * BUSTUB_PAGE_SIZE);
+  for (uint32_t queue_depth : {1, 4}) {
+    DiskLatencyModel model;
+    model.read_latency_ = milliseconds(2);
+    model.queue_depth_ = queue_depth;
+    DiskManagerMemory dm(0, model);
+
+    // Scenario: four reads issued together overlap as far as the queue lets them.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<void>> reads;
+    for (int i = 0; i < 4; i++) {
+      reads.push_back(dm.ReadPageAsync(i * 10, buf.data() + i * BUSTUB_PAGE_SIZE));
+    }
+    for (auto &read : reads) {
+      read.get();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(milliseconds(8), dm.GetServiceTime());
+    if (queue_depth == 1) {
+      EXPECT_GE(elapsed, milliseconds(8));
+      EXPECT_GT(dm.GetQueueWaitTime().count(), 0);
+    } else {
+      EXPECT_GE(elapsed, milliseconds(2));
+      EXPECT_EQ(0, dm.GetQueueWaitTime().count());
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, BandwidthAndSeekTest) {
+  DiskLatencyModel model;
+  model.read_latency_ = milliseconds(1);
+  model.seek_latency_ = milliseconds(5);
+  model.sync_latency_ = milliseconds(3);
+  // one page per millisecond
+  model.read_bandwidth_ = BUSTUB_PAGE_SIZE * 1000;
+  DiskManagerMemory dm(0, model);
+  std::vector<char> buf(8 * BUSTUB_PAGE_SIZE);
+
+  // Scenario: a run of consecutive pages is one operation: one seek and one latency, then the transfer of all pages.
+  std::vector<std::pair<page_id_t, char *>> pages;
+  for (int i = 0; i < 8; i++) {
+    pages.emplace_back(i, buf.data() + i * BUSTUB_PAGE_SIZE);
+  }
+  dm.ReadPages(pages);
+  EXPECT_EQ(1, dm.GetNumOperations());
+  EXPECT_EQ(1, dm.GetNumSeeks());
+  EXPECT_EQ(milliseconds(5 + 1 + 8), dm.GetServiceTime());
+
+  // Scenario: a read that goes on where the last one ended does not seek, one elsewhere does.
+  dm.ReadPage(8, buf.data());
+  EXPECT_EQ(1, dm.GetNumSeeks());
+  EXPECT_EQ(milliseconds(14 + 1 + 1), dm.GetServiceTime());
+  dm.ReadPage(100, buf.data());
+  EXPECT_EQ(2, dm.GetNumSeeks());
+  EXPECT_EQ(milliseconds(16 + 5 + 1 + 1), dm.GetServiceTime());
+  EXPECT_EQ(10, dm.GetNumReads());
+  EXPECT_EQ(3, dm.GetNumOperations());
+
+  // Scenario: writes have no latency in this model but still seek, and a sync comes on top.
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(0, buf.data());
+  dm.SyncPages();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(5 + 3));
+  EXPECT_EQ(1, dm.GetNumSyncs());
+}
+
+}  // namespace bustub
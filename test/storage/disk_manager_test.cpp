@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <unistd.h>
+#include <algorithm>
 #include <cstring>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -23,12 +28,16 @@ class DiskManagerTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
+    remove("test.db.1");
+    remove("test.db.2");
     remove("test.log");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
+    remove("test.db.1");
+    remove("test.db.2");
     remove("test.log");
   };
 };
@@ -55,6 +64,366 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPastEndTest) {
+  char buf[BUSTUB_PAGE_SIZE];
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+  {
+    auto dm = DiskManager(db_file);
+    dm.WritePage(2, data);
+    // Pages past the end of the file and holes before it read as zeros.
+    std::memset(buf, 'x', sizeof(buf));
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+    std::memset(buf, 'x', sizeof(buf));
+    dm.ReadPage(1, buf);
+    EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+    dm.SyncPages();
+    EXPECT_EQ(1, dm.GetNumSyncs());
+    dm.ShutDown();
+  }
+
+  // A reopened file knows its size.
+  auto dm = DiskManager(db_file);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Every thread writes and reads back its own pages, interleaved with the other threads.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm, tid] {
+      char data[BUSTUB_PAGE_SIZE];
+      char buf[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, 'a' + page_id % 26, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + page_id % 26, buf[0]);
+    EXPECT_EQ('a' + page_id % 26, buf[BUSTUB_PAGE_SIZE - 1]);
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char aligned[BUSTUB_PAGE_SIZE];
+  // One byte into an aligned buffer, so that it is certainly not aligned.
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char unaligned_storage[BUSTUB_PAGE_SIZE + 1];
+  char *unaligned = unaligned_storage + 1;
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+
+  // Aligned buffers go straight to the file, unaligned ones through a bounce buffer; both read back the same.
+  std::memset(aligned, 'a', sizeof(aligned));
+  dm.WritePage(0, aligned);
+  std::memset(unaligned, 'b', BUSTUB_PAGE_SIZE);
+  dm.WritePage(2, unaligned);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ReadPage(2, aligned);
+  EXPECT_EQ(std::memcmp(aligned, unaligned, sizeof(aligned)), 0);
+  std::memset(aligned, 'a', sizeof(aligned));
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(std::memcmp(aligned, unaligned, sizeof(aligned)), 0);
+  // The hole and the page past the end read as zeros.
+  dm.ReadPage(1, unaligned);
+  EXPECT_EQ(std::memcmp(zeros, unaligned, sizeof(zeros)), 0);
+  dm.ReadPage(3, aligned);
+  EXPECT_EQ(std::memcmp(zeros, aligned, sizeof(zeros)), 0);
+  dm.ShutDown();
+
+  // The file is an ordinary file, buffered I/O reads what direct I/O wrote.
+  auto buffered_dm = DiskManager(db_file);
+  EXPECT_FALSE(buffered_dm.IsDirectIo());
+  buffered_dm.ReadPage(2, aligned);
+  EXPECT_EQ('b', aligned[0]);
+  EXPECT_EQ('b', aligned[BUSTUB_PAGE_SIZE - 1]);
+  buffered_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  // Two runs, one of them across a map page, and a page on its own, handed over out of order.
+  const std::vector<page_id_t> page_ids = {3, 1, 2, 10, FreeSpaceMap::PAGES_PER_MAP_PAGE + 1,
+                                           FreeSpaceMap::PAGES_PER_MAP_PAGE - 2, FreeSpaceMap::PAGES_PER_MAP_PAGE,
+                                           FreeSpaceMap::PAGES_PER_MAP_PAGE - 1};
+  std::vector<std::vector<char>> data;
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    data.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>('a' + i));
+  }
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], data[i].data());
+  }
+  dm.WritePages(pages);
+  EXPECT_EQ(static_cast<int>(page_ids.size()), dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    dm.ReadPage(page_ids[i], buf);
+    EXPECT_EQ(std::memcmp(buf, data[i].data(), sizeof(buf)), 0);
+  }
+  // The runs did not spill into their neighbours or the map page.
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+  dm.ReadPage(4, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  const page_id_t end = FreeSpaceMap::PAGES_PER_MAP_PAGE + 2;
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id : {1, 2, 3, 10, end - 4, end - 3, end - 2, end - 1}) {
+    std::fill(data.begin(), data.end(), static_cast<char>('a' + page_id % 26));
+    dm.WritePage(page_id, data.data());
+  }
+
+  // A run across a map page, a run that ends past the end of the file and a page on its own, out of order.
+  const std::vector<page_id_t> page_ids = {end, 10, end - 2, 3, end - 1, 1, end - 3, 2, end + 1};
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(BUSTUB_PAGE_SIZE, 'x'));
+  std::vector<std::pair<page_id_t, char *>> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], bufs[i].data());
+  }
+  dm.ReadPages(pages);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const char expected = page_ids[i] < end ? static_cast<char>('a' + page_ids[i] % 26) : 0;
+    EXPECT_EQ(expected, bufs[i][0]) << "page " << page_ids[i];
+    EXPECT_EQ(expected, bufs[i][BUSTUB_PAGE_SIZE - 1]) << "page " << page_ids[i];
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  std::string db_file("test.db");
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE];
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t i = 0; i < 100; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      std::memset(data, 'a' + i % 26, sizeof(data));
+      dm.WritePage(i, data);
+    }
+    for (page_id_t i = 10; i < 20; i++) {
+      dm.DeallocatePage(i);
+    }
+    EXPECT_EQ(90, dm.GetNumAllocatedPages());
+    dm.ShutDown();
+  }
+
+  // Scenario: the free space map is stored in the file, a reopened file reuses the freed pages.
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(90, dm.GetNumAllocatedPages());
+  for (page_id_t i = 10; i < 20; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  EXPECT_EQ(100, dm.AllocatePage());
+  // The map pages do not get in the way of the pages.
+  for (page_id_t i = 0; i < 100; i++) {
+    dm.ReadPage(i, buf);
+    EXPECT_EQ('a' + i % 26, buf[0]);
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageChecksumTest) {
+  std::string db_file("test.db");
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  std::vector<std::vector<char>> bufs(8, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::pair<page_id_t, char *>> pages;
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    pages.emplace_back(page_id, bufs[page_id].data());
+  }
+  {
+    auto dm = DiskManager(db_file, false, true);
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      std::fill(data.begin(), data.end(), static_cast<char>('a' + page_id));
+      dm.WritePage(page_id, data.data());
+    }
+    // The checksum goes into the copy that is written, the page of the caller is left alone.
+    EXPECT_EQ('h', data[BUSTUB_PAGE_SIZE - 1]);
+    dm.ReadPage(3, buf.data());
+    EXPECT_EQ('d', buf[0]);
+    EXPECT_TRUE(DiskManager::IsPageChecksumValid(buf.data()));
+    // A page that was never written reads as zeros, which pass.
+    dm.ReadPage(100, buf.data());
+    dm.ReadPages(pages);
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+
+  // Scenario: page 2 is torn, the first half of a new version reached the disk but the second half with the checksum
+  // did not. A bit of page 5 flips.
+  {
+    auto dm = DiskManager(db_file);
+    dm.ReadPage(2, buf.data());
+    std::fill(buf.begin(), buf.begin() + BUSTUB_PAGE_SIZE / 2, 'z');
+    dm.WritePage(2, buf.data());
+    dm.ReadPage(5, buf.data());
+    buf[100] ^= 1;
+    dm.WritePage(5, buf.data());
+    dm.ShutDown();
+  }
+  auto dm = DiskManager(db_file, false, true);
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    dm.ReadPage(page_id, buf.data());
+  }
+  EXPECT_EQ(2, dm.GetNumChecksumFailures());
+  // Vectored reads are checked as well.
+  dm.ReadPages(pages);
+  EXPECT_EQ(4, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  std::string db_file("test.db");
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE];
+  const page_id_t header_1 = DiskManager::SegmentHeaderPageId(1);
+  const page_id_t header_2 = DiskManager::SegmentHeaderPageId(2);
+  {
+    // Without segment files, everything stays in the db file.
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(DEFAULT_SEGMENT_ID, dm.CreateSegment());
+    dm.ShutDown();
+  }
+  {
+    auto dm = DiskManager(db_file, false, false, true);
+    EXPECT_EQ(1, dm.CreateSegment());
+    EXPECT_EQ(2, dm.CreateSegment());
+    EXPECT_TRUE(dm.IsPageAllocated(header_1));
+    EXPECT_EQ(2, dm.GetNumAllocatedPages());
+
+    // Pages allocated near a page of a segment stay in it, one after the other, and the db file is left alone.
+    for (page_id_t i = 1; i <= 10; i++) {
+      EXPECT_EQ(header_1 + i, dm.AllocatePage(header_1 + i - 1));
+      EXPECT_EQ(header_2 + i, dm.AllocatePage(header_2 + i - 1));
+    }
+    EXPECT_EQ(0, dm.AllocatePage());
+    EXPECT_EQ(1, dm.SegmentOf(header_1 + 10));
+
+    // The same index in different segments is a different page in a different file.
+    std::vector<std::pair<page_id_t, const char *>> pages;
+    std::vector<std::vector<char>> contents;
+    for (page_id_t page_id : {0, header_1 + 1, header_1 + 2, header_1 + 3, header_2 + 1, header_2 + 2}) {
+      contents.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>(page_id % 251 + DiskManager::SegmentOf(page_id)));
+    }
+    page_id_t i = 0;
+    for (page_id_t page_id : {0, header_1 + 1, header_1 + 2, header_1 + 3, header_2 + 1, header_2 + 2}) {
+      pages.emplace_back(page_id, contents[i++].data());
+    }
+    dm.WritePages(pages);
+    for (const auto &[page_id, page_data] : pages) {
+      dm.ReadPage(page_id, buf);
+      EXPECT_EQ(0, std::memcmp(buf, page_data, BUSTUB_PAGE_SIZE)) << "page " << page_id;
+    }
+
+    // Allocation honors the instances of a parallel buffer pool, whatever the first page id of the segment.
+    for (uint32_t instance = 0; instance < 3; instance++) {
+      EXPECT_EQ(instance, static_cast<uint32_t>(dm.AllocatePage(header_2 + 10, 3, instance)) % 3);
+    }
+
+    std::memset(data, 'x', sizeof(data));
+    dm.WritePage(header_2 + 5, data);
+    dm.ShutDown();
+  }
+
+  // Scenario: the segment files are found again next to the db file, with their free space maps.
+  {
+    auto dm = DiskManager(db_file, false, false, true);
+    EXPECT_TRUE(dm.HasSegment(1));
+    EXPECT_TRUE(dm.HasSegment(2));
+    EXPECT_EQ(26, dm.GetNumAllocatedPages());
+    EXPECT_EQ(header_1 + 11, dm.AllocatePage(header_1 + 10));
+    dm.ReadPage(header_2 + 5, buf);
+    EXPECT_EQ('x', buf[0]);
+
+    // Deleting a segment deletes its file, and its pages with it.
+    EXPECT_FALSE(dm.DeleteSegment(DEFAULT_SEGMENT_ID));
+    EXPECT_TRUE(dm.DeleteSegment(1));
+    EXPECT_FALSE(dm.DeleteSegment(1));
+    EXPECT_FALSE(dm.HasSegment(1));
+    EXPECT_EQ(-1, access("test.db.1", F_OK));
+    EXPECT_FALSE(dm.IsPageAllocated(header_1 + 1));
+    EXPECT_EQ(15, dm.GetNumAllocatedPages());
+    dm.ReadPage(header_1 + 1, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.ReadPage(header_2 + 1, buf);
+    EXPECT_EQ(static_cast<char>((header_2 + 1) % 251 + 2), buf[0]);
+
+    // The id of the deleted segment is taken again, by a new, empty segment.
+    EXPECT_EQ(1, dm.CreateSegment());
+    EXPECT_EQ(header_1 + 1, dm.AllocatePage(header_1));
+    dm.ReadPage(header_1 + 2, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, NoSegmentFilesTest) {
+  std::string db_file("test.db");
+  std::vector<char> data(BUSTUB_PAGE_SIZE, 'a');
+  std::vector<char> buf(BUSTUB_PAGE_SIZE);
+  const page_id_t far_page_id = DiskManager::PAGES_PER_SEGMENT + 5;
+  {
+    auto dm = DiskManager(db_file, false, false, true);
+    EXPECT_EQ(1, dm.CreateSegment());
+    dm.ShutDown();
+  }
+
+  // Without segment files, the segment files on disk are left alone and the db file holds every page id, so a page
+  // id past the first segment is not the same page as the one at its index in segment 0.
+  auto dm = DiskManager(db_file);
+  EXPECT_FALSE(dm.HasSegment(1));
+  dm.WritePage(5, data.data());
+  data[0] = 'z';
+  dm.WritePage(far_page_id, data.data());
+  dm.ReadPage(5, buf.data());
+  EXPECT_EQ('a', buf[0]);
+  dm.ReadPage(far_page_id, buf.data());
+  EXPECT_EQ('z', buf[0]);
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
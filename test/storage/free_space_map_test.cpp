@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/storage/free_space_map_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, SampleTest) {
+  FreeSpaceMap map;
+  for (page_id_t i = 0; i < 100; i++) {
+    EXPECT_EQ(i, map.Allocate());
+  }
+  EXPECT_EQ(100, map.GetNumAllocated());
+  EXPECT_EQ(100, map.GetEnd());
+
+  // Scenario: freed page ids are reused lowest first, before the map grows.
+  EXPECT_TRUE(map.Deallocate(42));
+  EXPECT_TRUE(map.Deallocate(7));
+  EXPECT_FALSE(map.Deallocate(7));
+  EXPECT_FALSE(map.Deallocate(1000));
+  EXPECT_FALSE(map.IsAllocated(7));
+  EXPECT_EQ(7, map.Allocate());
+  EXPECT_EQ(42, map.Allocate());
+  EXPECT_EQ(100, map.Allocate());
+
+  // Scenario: a near page id picks the first free page after it, so pages of one table stay together.
+  for (page_id_t i = 50; i < 60; i++) {
+    EXPECT_TRUE(map.Deallocate(i));
+  }
+  EXPECT_TRUE(map.Deallocate(3));
+  EXPECT_EQ(50, map.Allocate(49));
+  EXPECT_EQ(51, map.Allocate(50));
+  EXPECT_EQ(3, map.Allocate());
+  // Without a free page after the near page id, the lowest free page id is taken rather than growing the map.
+  EXPECT_EQ(52, map.Allocate(90));
+  EXPECT_EQ(101, map.GetEnd());
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, InstancesTest) {
+  FreeSpaceMap map;
+  // Scenario: round robin over three instances hands out consecutive page ids.
+  for (page_id_t i = 0; i < 30; i++) {
+    EXPECT_EQ(i, map.Allocate(INVALID_PAGE_ID, 3, i % 3));
+  }
+  // Scenario: each instance only ever gets its own page ids back.
+  EXPECT_TRUE(map.Deallocate(4));
+  EXPECT_TRUE(map.Deallocate(13));
+  EXPECT_EQ(30, map.Allocate(INVALID_PAGE_ID, 3, 0));
+  EXPECT_EQ(4, map.Allocate(INVALID_PAGE_ID, 3, 1));
+  EXPECT_EQ(13, map.Allocate(10, 3, 1));
+  EXPECT_EQ(31, map.Allocate(INVALID_PAGE_ID, 3, 1));
+  EXPECT_EQ(32, map.Allocate(INVALID_PAGE_ID, 3, 2));
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, MapPageTest) {
+  const page_id_t num_pages = FreeSpaceMap::PAGES_PER_MAP_PAGE + 100;
+  FreeSpaceMap map;
+  for (page_id_t i = 0; i < num_pages; i++) {
+    map.Allocate();
+  }
+  for (page_id_t i = 0; i < num_pages; i += 3) {
+    map.Deallocate(i);
+  }
+  EXPECT_EQ(2, map.GetNumMapPages());
+  EXPECT_EQ(1, FreeSpaceMap::MapPageOf(FreeSpaceMap::PAGES_PER_MAP_PAGE));
+
+  // Scenario: the map survives a round trip through its map pages.
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  FreeSpaceMap loaded;
+  for (size_t i = 0; i < map.GetNumMapPages(); i++) {
+    map.StoreMapPage(i, data.data());
+    loaded.LoadMapPage(i, data.data());
+  }
+  EXPECT_EQ(map.GetNumAllocated(), loaded.GetNumAllocated());
+  EXPECT_EQ(map.GetEnd(), loaded.GetEnd());
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(map.IsAllocated(i), loaded.IsAllocated(i));
+  }
+  EXPECT_EQ(0, loaded.Allocate());
+  EXPECT_EQ(3, loaded.Allocate());
+}
+
+}  // namespace bustub
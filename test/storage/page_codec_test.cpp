@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec_test.cpp
+//
+// Identification: test/storage/page_codec_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_codec.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Compress and decompress the data, and return the compressed size. */
+auto RoundTrip(const std::vector<char> &data) -> size_t {
+  std::vector<char> compressed(PageCodec::MaxCompressedSize(data.size()));
+  const size_t size = PageCodec::Compress(data.data(), data.size(), compressed.data());
+  EXPECT_LE(size, compressed.size());
+  std::vector<char> decompressed(data.size(), 'x');
+  EXPECT_TRUE(PageCodec::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+  EXPECT_EQ(data, decompressed);
+  return size;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(PageCodecTest, RoundTripTest) {
+  // Scenario: An empty page shrinks to a few bytes.
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  EXPECT_LT(RoundTrip(page), 32);
+
+  // Scenario: A page of fixed-width integers, like a table page with integer columns, compresses well.
+  for (size_t i = 0; i < BUSTUB_PAGE_SIZE / 2; i += sizeof(int32_t)) {
+    const auto value = static_cast<int32_t>(i / 8);
+    std::memcpy(&page[i], &value, sizeof(value));
+  }
+  EXPECT_LT(RoundTrip(page), BUSTUB_PAGE_SIZE / 2);
+
+  // Scenario: Random data does not compress, but still round trips within the bound.
+  std::mt19937 gen(42);
+  for (auto &c : page) {
+    c = static_cast<char>(gen());
+  }
+  EXPECT_GT(RoundTrip(page), BUSTUB_PAGE_SIZE);
+
+  // Scenario: Inputs shorter than a match, and long runs that need extended lengths.
+  EXPECT_EQ(1, RoundTrip({}));
+  RoundTrip({'a', 'b', 'c'});
+  std::vector<char> runs;
+  for (int i = 0; i < 10; i++) {
+    runs.insert(runs.end(), 300 + i, static_cast<char>('a' + i));
+    runs.insert(runs.end(), page.begin(), page.begin() + 20 * i);
+  }
+  RoundTrip(runs);
+}
+
+// NOLINTNEXTLINE
+TEST(PageCodecTest, CorruptInputTest) {
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < page.size(); i++) {
+    page[i] = static_cast<char>(i % 7 == 0 ? i : 0);
+  }
+  std::vector<char> compressed(PageCodec::MaxCompressedSize(page.size()));
+  const size_t size = PageCodec::Compress(page.data(), page.size(), compressed.data());
+  std::vector<char> out(page.size());
+
+  // Scenario: A truncated input, an input for a different size and a reference before the start are rejected.
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), size - 1, out.data(), out.size()));
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), size, out.data(), out.size() - 1));
+  EXPECT_FALSE(PageCodec::Decompress(compressed.data(), 0, out.data(), out.size()));
+  const char bad_offset[] = {0x10, 'a', 0x05, 0x00};
+  EXPECT_FALSE(PageCodec::Decompress(bad_offset, sizeof(bad_offset), out.data(), out.size()));
+}
+
+}  // namespace bustub
@@ -21,6 +21,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +72,59 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapSegmentTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db", false, false, true);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *table_a = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+  auto *table_b = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+
+  // Scenario: two tables filled at the same time each get their pages one after the other, in their own segment.
+  EXPECT_EQ(1, DiskManager::SegmentOf(table_a->GetFirstPageId()));
+  EXPECT_EQ(2, DiskManager::SegmentOf(table_b->GetFirstPageId()));
+  const std::string text(100, 'x');
+  for (int i = 0; i < 1000; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(text)}, &schema};
+    RID rid;
+    ASSERT_TRUE(table_a->InsertTuple(tuple, &rid, transaction));
+    ASSERT_TRUE(table_b->InsertTuple(tuple, &rid, transaction));
+  }
+  for (auto *table : {table_a, table_b}) {
+    page_id_t expected_page_id = table->GetFirstPageId();
+    int i = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      EXPECT_EQ(i++, itr->GetValue(&schema, 0).GetAs<int32_t>());
+      if (itr->GetRid().GetPageId() != expected_page_id) {
+        EXPECT_EQ(++expected_page_id, itr->GetRid().GetPageId());
+      }
+    }
+    EXPECT_EQ(1000, i);
+    EXPECT_GT(expected_page_id, table->GetFirstPageId());
+  }
+
+  // Scenario: dropping a table deletes its segment file, the other table is left alone.
+  EXPECT_TRUE(table_a->Drop());
+  EXPECT_EQ(INVALID_PAGE_ID, table_a->GetFirstPageId());
+  EXPECT_FALSE(disk_manager->HasSegment(1));
+  EXPECT_TRUE(disk_manager->HasSegment(2));
+  int num_tuples = 0;
+  for (auto itr = table_b->Begin(transaction); itr != table_b->End(); ++itr) {
+    num_tuples++;
+  }
+  EXPECT_EQ(1000, num_tuples);
+  EXPECT_TRUE(table_b->Drop());
+  EXPECT_FALSE(disk_manager->HasSegment(2));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table_a;
+  delete table_b;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub
@@ -0,0 +1,593 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bpm_bench.cpp
+//
+// Identification: tools/bpm_bench/bpm_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_table.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+using bustub::AccessType;
+using bustub::BufferPoolManager;
+using bustub::BufferPoolManagerInstance;
+using bustub::DiskLatencyModel;
+using bustub::DiskManager;
+using bustub::DiskManagerMemory;
+using bustub::ExtendibleHashTable;
+using bustub::frame_id_t;
+using bustub::HugePageMode;
+using bustub::page_id_t;
+using bustub::PageTable;
+using bustub::ParallelBufferPoolManager;
+using bustub::ReplacementPolicy;
+
+namespace {
+
+enum class BenchMode {
+  /** Fetch/unpin throughput of a single instance against a sharded pool. */
+  SCALING,
+  /** Hit rate of point lookups on a hot set while sequential scans run. */
+  SCAN,
+  /** Hit rate and throughput of every replacement policy on synthetic access traces. */
+  HIT_RATE,
+  /** Latency of page table lookups and of buffer pool hits. */
+  LOOKUP,
+  /** Memory footprint and throughput of buffered against direct I/O. */
+  DIRECT_IO,
+};
+
+struct BenchConfig {
+  BenchMode mode_{BenchMode::SCALING};
+  /** Total number of frames, split evenly over the instances. */
+  size_t pool_size_{1024};
+  /** Number of distinct pages the workload touches. */
+  size_t num_pages_{1024};
+  /** Number of instances for the sharded run. */
+  size_t num_instances_{16};
+  /** Largest thread count to measure; thread counts double from 1 up to this. */
+  size_t max_threads_{32};
+  /** How long each data point runs. */
+  std::chrono::milliseconds duration_{1000};
+  /** Number of fetches per trace in the hit-rate run. */
+  size_t ops_{1000000};
+  /** Service times of the in-memory disk behind the pools; direct-io runs on a real file instead. */
+  DiskLatencyModel disk_model_{DiskLatencyModel::None()};
+};
+
+auto UsageMessage() -> std::string {
+  return "usage: bustub-bpm-bench [--mode scaling|scan|hit-rate|lookup|direct-io] [--pool-size <frames>]\n"
+         "                        [--pages <pages>] [--disk none|nvme|hdd]\n"
+         "                        [--instances <n>] [--max-threads <n>] [--duration <ms>] [--ops <n>]\n"
+         "scaling: measures buffer pool fetch/unpin throughput from 1 up to max-threads threads, for a single\n"
+         "         instance and for a pool sharded over <n> instances.\n"
+         "scan:    measures the hit rate of max-threads threads doing point lookups on a hot set of half the pool,\n"
+         "         without scans, and while a thread keeps scanning four times the pool with and without the Scan\n"
+         "         access type.\n"
+         "hit-rate: replays <ops> fetches over eight times as many pages as the pool holds through a single\n"
+         "         instance with every replacement policy, for a serial trace and Zipfian traces of increasing skew,\n"
+         "         and reports the hit rate and fetches per second.\n"
+         "lookup:   measures the latency of page table lookups with 1 up to max-threads threads, for the extendible\n"
+         "         hash table the pool used to use and for PageTable, and of a fetch/unpin hit on a single instance.\n"
+         "direct-io: runs random fetches over four times as many pages as the pool holds, stored in a database file\n"
+         "         (bpm_bench.db in the working directory), from 1 up to max-threads threads with buffered and with\n"
+         "         direct I/O, and reports fetches per second and the memory held by the frames and by the OS page\n"
+         "         cache for the file.\n"
+         "--disk:   the latency model of the in-memory disk behind the pools of the other modes; none is plain\n"
+         "         memcpy, nvme and hdd delay every read and write as such a device would.\n";
+}
+
+auto ParseArgs(int argc, char **argv, BenchConfig *config) -> bool {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    if (strcmp(argv[i], "--mode") == 0) {
+      if (strcmp(argv[i + 1], "scaling") == 0) {
+        config->mode_ = BenchMode::SCALING;
+      } else if (strcmp(argv[i + 1], "scan") == 0) {
+        config->mode_ = BenchMode::SCAN;
+      } else if (strcmp(argv[i + 1], "hit-rate") == 0) {
+        config->mode_ = BenchMode::HIT_RATE;
+      } else if (strcmp(argv[i + 1], "lookup") == 0) {
+        config->mode_ = BenchMode::LOOKUP;
+      } else if (strcmp(argv[i + 1], "direct-io") == 0) {
+        config->mode_ = BenchMode::DIRECT_IO;
+      } else {
+        return false;
+      }
+      i++;
+      continue;
+    }
+    if (strcmp(argv[i], "--disk") == 0) {
+      if (strcmp(argv[i + 1], "none") == 0) {
+        config->disk_model_ = DiskLatencyModel::None();
+      } else if (strcmp(argv[i + 1], "nvme") == 0) {
+        config->disk_model_ = DiskLatencyModel::Nvme();
+      } else if (strcmp(argv[i + 1], "hdd") == 0) {
+        config->disk_model_ = DiskLatencyModel::Hdd();
+      } else {
+        return false;
+      }
+      i++;
+      continue;
+    }
+    auto value = std::stoul(argv[i + 1]);
+    if (strcmp(argv[i], "--pool-size") == 0) {
+      config->pool_size_ = value;
+    } else if (strcmp(argv[i], "--pages") == 0) {
+      config->num_pages_ = value;
+    } else if (strcmp(argv[i], "--instances") == 0) {
+      config->num_instances_ = value;
+    } else if (strcmp(argv[i], "--max-threads") == 0) {
+      config->max_threads_ = value;
+    } else if (strcmp(argv[i], "--duration") == 0) {
+      config->duration_ = std::chrono::milliseconds(value);
+    } else if (strcmp(argv[i], "--ops") == 0) {
+      config->ops_ = value;
+    } else {
+      return false;
+    }
+    i++;
+  }
+  return config->num_instances_ > 0 && config->pool_size_ >= config->num_instances_;
+}
+
+/** Create the working set and leave every page unpinned, so that the measured loop starts from a warm pool. */
+auto Preload(BufferPoolManager *bpm, size_t num_pages) -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      throw std::runtime_error("buffer pool is too small to preload the working set");
+    }
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  return page_ids;
+}
+
+/** Random fetch/unpin loop over the working set. @return operations per second over all threads */
+auto RunFetchUnpin(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                   std::chrono::milliseconds duration) -> double {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      uint64_t ops = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto page_id = page_ids[dist(gen)];
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        page_id_t stored;
+        memcpy(&stored, page->GetData(), sizeof(stored));
+        page->RUnlatch();
+        if (stored != page_id) {
+          throw std::runtime_error(fmt::format("page {} holds data of page {}", page_id, stored));
+        }
+        bpm->UnpinPage(page_id, false);
+        ops++;
+      }
+      total_ops += ops;
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(total_ops.load()) / elapsed.count();
+}
+
+struct ScanResult {
+  /** Share of the lookups that found their page in the pool. */
+  double lookup_hit_rate_;
+  /** Lookups per second over all lookup threads. */
+  double lookups_per_second_;
+};
+
+/**
+ * Point lookups on a hot set of half the pool, optionally while one thread keeps scanning a table of four times the
+ * pool with the given access type. The scan fetches every page several times in a row, the way a tuple-at-a-time
+ * iterator does; that is what gives scanned pages enough history to push hot pages out of a plain LRU-K pool.
+ */
+auto RunScanResistance(const BenchConfig &config, bool with_scan, AccessType scan_access) -> ScanResult {
+  const size_t hot_pages = config.pool_size_ / 2;
+  const size_t scan_pages = config.pool_size_ * 4;
+  auto disk = std::make_unique<DiskManagerMemory>(hot_pages + scan_pages, config.disk_model_);
+  // k = 2, so that the warm-up below is enough to give every hot page its full history.
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(config.pool_size_, disk.get(), 2);
+  auto hot = Preload(bpm.get(), hot_pages);
+  auto table = Preload(bpm.get(), scan_pages);
+  for (int round = 0; round < 2; round++) {
+    for (auto page_id : hot) {
+      bpm->FetchPage(page_id, AccessType::Lookup);
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+
+  const auto hits_before = bpm->GetNumHits(AccessType::Lookup);
+  const auto misses_before = bpm->GetNumMisses(AccessType::Lookup);
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  if (with_scan) {
+    threads.emplace_back([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < table.size() && !stop.load(std::memory_order_relaxed); i++) {
+          // Like TableIterator, which fetches the page again for every tuple on it.
+          for (int tuple = 0; tuple < 8; tuple++) {
+            if (bpm->FetchPage(table[i], scan_access) != nullptr) {
+              bpm->UnpinPage(table[i], false);
+            }
+          }
+        }
+      }
+    });
+  }
+  for (size_t tid = 0; tid < config.max_threads_; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<size_t> dist(0, hot.size() - 1);
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto page_id = hot[dist(gen)];
+        if (bpm->FetchPage(page_id, AccessType::Lookup) != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(config.duration_);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto hits = static_cast<double>(bpm->GetNumHits(AccessType::Lookup) - hits_before);
+  const auto misses = static_cast<double>(bpm->GetNumMisses(AccessType::Lookup) - misses_before);
+  return {hits / (hits + misses), (hits + misses) / elapsed.count()};
+}
+
+void RunScanBench(const BenchConfig &config) {
+  fmt::print("pool_size={} hot_pages={} scan_pages={} lookup_threads={} duration={}ms\n", config.pool_size_,
+             config.pool_size_ / 2, config.pool_size_ * 4, config.max_threads_, config.duration_.count());
+  fmt::print("{:>24} {:>16} {:>16}\n", "concurrent scan", "lookup hit rate", "lookups/s");
+  auto print_row = [](const char *name, const ScanResult &result) {
+    fmt::print("{:>24} {:>15.2f}% {:>16.0f}\n", name, result.lookup_hit_rate_ * 100, result.lookups_per_second_);
+  };
+  print_row("none", RunScanResistance(config, false, AccessType::Unknown));
+  print_row("AccessType::Unknown", RunScanResistance(config, true, AccessType::Unknown));
+  print_row("AccessType::Scan", RunScanResistance(config, true, AccessType::Scan));
+}
+
+/**
+ * Draws values in [0, n) with a Zipfian distribution: value i is drawn with a probability proportional to
+ * 1 / (i + 1)^theta. Uses the method of Gray et al., "Quickly Generating Billion-Record Synthetic Databases".
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t n, double theta)
+      : n_(n),
+        theta_(theta),
+        alpha_(1.0 / (1.0 - theta)),
+        zetan_(Zeta(n, theta)),
+        eta_((1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - Zeta(2, theta) / zetan_)) {}
+
+  auto operator()(std::mt19937 &gen) -> size_t {
+    const double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+    const double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    auto value = static_cast<size_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    return std::min(value, n_ - 1);
+  }
+
+ private:
+  static auto Zeta(size_t n, double theta) -> double {
+    double sum = 0;
+    for (size_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  size_t n_;
+  double theta_;
+  double alpha_;
+  double zetan_;
+  double eta_;
+};
+
+/** @return the page indexes of a trace: a serial loop over all pages when theta is 0, Zipfian otherwise */
+auto MakeTrace(size_t num_pages, size_t ops, double theta) -> std::vector<size_t> {
+  std::vector<size_t> trace(ops);
+  if (theta == 0) {
+    for (size_t i = 0; i < ops; i++) {
+      trace[i] = i % num_pages;
+    }
+    return trace;
+  }
+  std::mt19937 gen(0);
+  ZipfianGenerator zipf(num_pages, theta);
+  for (auto &page : trace) {
+    page = zipf(gen);
+  }
+  return trace;
+}
+
+struct HitRateResult {
+  double hit_rate_;
+  double fetches_per_second_;
+};
+
+/** Replay the trace through a pool of the given policy, one fetch/unpin at a time. */
+auto RunTrace(const BenchConfig &config, ReplacementPolicy policy, const std::vector<size_t> &trace, size_t num_pages)
+    -> HitRateResult {
+  auto disk = std::make_unique<DiskManagerMemory>(num_pages, config.disk_model_);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(config.pool_size_, disk.get(), bustub::LRUK_REPLACER_K,
+                                                         nullptr, policy);
+  auto page_ids = Preload(bpm.get(), num_pages);
+
+  const auto hits_before = bpm->GetNumHits(AccessType::Unknown);
+  const auto misses_before = bpm->GetNumMisses(AccessType::Unknown);
+  auto start = std::chrono::steady_clock::now();
+  for (auto page : trace) {
+    if (bpm->FetchPage(page_ids[page]) == nullptr) {
+      throw std::runtime_error("no free frame during a single-threaded replay");
+    }
+    bpm->UnpinPage(page_ids[page], false);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto hits = static_cast<double>(bpm->GetNumHits(AccessType::Unknown) - hits_before);
+  const auto misses = static_cast<double>(bpm->GetNumMisses(AccessType::Unknown) - misses_before);
+  return {hits / (hits + misses), static_cast<double>(trace.size()) / elapsed.count()};
+}
+
+void RunHitRateBench(const BenchConfig &config) {
+  const size_t num_pages = config.pool_size_ * 8;
+  fmt::print("pool_size={} pages={} ops={}\n", config.pool_size_, num_pages, config.ops_);
+  const std::vector<std::pair<const char *, ReplacementPolicy>> policies{{"LRU", ReplacementPolicy::LRU},
+                                                                         {"LRU-K", ReplacementPolicy::LRU_K},
+                                                                         {"CLOCK", ReplacementPolicy::CLOCK},
+                                                                         {"2Q", ReplacementPolicy::TWO_Q},
+                                                                         {"ARC", ReplacementPolicy::ARC}};
+  const std::vector<std::pair<const char *, double>> traces{
+      {"Serial", 0}, {"Zipf_50", 0.5}, {"Zipf_75", 0.75}, {"Zipf_95", 0.95}, {"Zipf_99", 0.99}};
+
+  fmt::print("{:>8}", "trace");
+  for (const auto &[name, policy] : policies) {
+    fmt::print(" {:>19}", name);
+  }
+  fmt::print("\n");
+  for (const auto &[trace_name, theta] : traces) {
+    auto trace = MakeTrace(num_pages, config.ops_, theta);
+    fmt::print("{:>8}", trace_name);
+    for (const auto &[name, policy] : policies) {
+      auto result = RunTrace(config, policy, trace, num_pages);
+      fmt::print(" {:>6.2f}% {:>9.0f}/s", result.hit_rate_ * 100, result.fetches_per_second_);
+    }
+    fmt::print("\n");
+  }
+}
+
+/** Random lookups of the pages in the table. @return nanoseconds per lookup, as seen by each thread */
+template <typename Table>
+auto MeasureFind(Table *table, size_t num_pages, size_t num_threads, std::chrono::milliseconds duration) -> double {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages - 1));
+      uint64_t ops = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        frame_id_t frame_id;
+        if (!table->Find(dist(gen), frame_id)) {
+          throw std::runtime_error("page missing from the page table");
+        }
+        ops++;
+      }
+      total_ops += ops;
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() * static_cast<double>(num_threads) / static_cast<double>(total_ops.load());
+}
+
+void RunLookupBench(const BenchConfig &config) {
+  fmt::print("pool_size={} duration={}ms\n", config.pool_size_, config.duration_.count());
+  ExtendibleHashTable<page_id_t, frame_id_t> extendible(4);
+  PageTable page_table(config.pool_size_);
+  for (size_t i = 0; i < config.pool_size_; i++) {
+    extendible.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+  }
+  fmt::print("{:>8} {:>20} {:>20}\n", "threads", "extendible ns/find", "PageTable ns/find");
+  for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+    auto extendible_ns = MeasureFind(&extendible, config.pool_size_, num_threads, config.duration_);
+    auto page_table_ns = MeasureFind(&page_table, config.pool_size_, num_threads, config.duration_);
+    fmt::print("{:>8} {:>20.1f} {:>20.1f}\n", num_threads, extendible_ns, page_table_ns);
+  }
+
+  auto disk = std::make_unique<DiskManagerMemory>(config.pool_size_, config.disk_model_);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(config.pool_size_, disk.get());
+  auto page_ids = Preload(bpm.get(), config.pool_size_);
+  auto ops_per_second = RunFetchUnpin(bpm.get(), page_ids, 1, config.duration_);
+  fmt::print("fetch/unpin hit: {:.1f} ns\n", 1e9 / ops_per_second);
+}
+
+/** @return the number of bytes of the file that are in the OS page cache */
+auto CachedBytes(const std::string &file_name) -> size_t {
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat(fd, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 0;
+  }
+  const auto size = static_cast<size_t>(stat_buf.st_size);
+  void *ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    return 0;
+  }
+  const auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> resident((size + os_page_size - 1) / os_page_size);
+  size_t cached = 0;
+  if (mincore(ptr, size, resident.data()) == 0) {
+    for (auto page : resident) {
+      cached += (page & 1) * os_page_size;
+    }
+  }
+  munmap(ptr, size);
+  return cached;
+}
+
+/** Write dirty pages of the file out and drop all of its pages from the OS page cache. */
+void DropCachedPages(const std::string &file_name) {
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+auto HugePageModeName(HugePageMode mode) -> const char * {
+  switch (mode) {
+    case HugePageMode::EXPLICIT:
+      return "explicit";
+    case HugePageMode::TRANSPARENT:
+      return "transparent";
+    default:
+      return "none";
+  }
+}
+
+void RunDirectIoBench(const BenchConfig &config) {
+  const std::string db_file = "bpm_bench.db";
+  const size_t num_pages = config.pool_size_ * 4;
+  fmt::print("pool_size={} pages={} duration={}ms\n", config.pool_size_, num_pages, config.duration_.count());
+  fmt::print("{:>10} {:>8} {:>16} {:>12} {:>14} {:>12}\n", "I/O", "threads", "fetches/s", "frames MB", "OS cache MB",
+             "huge pages");
+  for (bool direct_io : {false, true}) {
+    std::remove(db_file.c_str());
+    auto disk = std::make_unique<DiskManager>(db_file, direct_io);
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(config.pool_size_, disk.get());
+    auto page_ids = Preload(bpm.get(), num_pages);
+    bpm->FlushAllPages();
+    // Both runs start with nothing of the file in the OS page cache.
+    DropCachedPages(db_file);
+    const char *name = !direct_io ? "buffered" : disk->IsDirectIo() ? "direct" : "(buffered)";
+    for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+      auto ops_per_second = RunFetchUnpin(bpm.get(), page_ids, num_threads, config.duration_);
+      const auto &frames = bpm->GetFrameMemory();
+      fmt::print("{:>10} {:>8} {:>16.0f} {:>12.1f} {:>14.1f} {:>12}\n", name, num_threads, ops_per_second,
+                 static_cast<double>(frames.GetSize()) / (1 << 20),
+                 static_cast<double>(CachedBytes(db_file)) / (1 << 20), HugePageModeName(frames.GetHugePageMode()));
+    }
+    bpm.reset();
+    disk->ShutDown();
+  }
+  std::remove(db_file.c_str());
+  std::remove("bpm_bench.log");
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  BenchConfig config;
+  if (!ParseArgs(argc, argv, &config)) {
+    std::cerr << UsageMessage();
+    return 1;
+  }
+  if (config.mode_ == BenchMode::SCAN) {
+    RunScanBench(config);
+    return 0;
+  }
+  if (config.mode_ == BenchMode::HIT_RATE) {
+    RunHitRateBench(config);
+    return 0;
+  }
+  if (config.mode_ == BenchMode::LOOKUP) {
+    RunLookupBench(config);
+    return 0;
+  }
+  if (config.mode_ == BenchMode::DIRECT_IO) {
+    RunDirectIoBench(config);
+    return 0;
+  }
+
+  fmt::print("pool_size={} pages={} duration={}ms\n", config.pool_size_, config.num_pages_, config.duration_.count());
+  fmt::print("{:>8} {:>16} {:>16} {:>8}\n", "threads", "1 instance", fmt::format("{} instances", config.num_instances_),
+             "speedup");
+
+  for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+    auto single_disk = std::make_unique<DiskManagerMemory>(config.num_pages_, config.disk_model_);
+    auto single = std::make_unique<BufferPoolManagerInstance>(config.pool_size_, single_disk.get());
+    auto single_pages = Preload(single.get(), config.num_pages_);
+    auto single_ops = RunFetchUnpin(single.get(), single_pages, num_threads, config.duration_);
+
+    auto sharded_disk = std::make_unique<DiskManagerMemory>(config.num_pages_, config.disk_model_);
+    auto sharded = std::make_unique<ParallelBufferPoolManager>(
+        config.num_instances_, config.pool_size_ / config.num_instances_, sharded_disk.get());
+    auto sharded_pages = Preload(sharded.get(), config.num_pages_);
+    auto sharded_ops = RunFetchUnpin(sharded.get(), sharded_pages, num_threads, config.duration_);
+
+    fmt::print("{:>8} {:>16.0f} {:>16.0f} {:>7.2f}x\n", num_threads, single_ops, sharded_ops, sharded_ops / single_ops);
+  }
+  return 0;
+}
@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_bench.cpp
+//
+// Identification: tools/compression_bench/compression_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "catalog/table_generator.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "fmt/core.h"
+#include "storage/disk/compressed_disk_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+
+using bustub::BufferPoolManagerInstance;
+using bustub::Catalog;
+using bustub::CompressedDiskManager;
+using bustub::DiskManager;
+using bustub::ExecutorContext;
+using bustub::LockManager;
+using bustub::page_id_t;
+using bustub::TableGenerator;
+using bustub::TableHeap;
+using bustub::TransactionManager;
+using bustub::Tuple;
+
+namespace {
+
+struct BenchConfig {
+  /** Database file to create for each run; it is removed afterwards. */
+  std::string db_file_{"compression_bench.db"};
+  /** Each generated table is filled up to this many times its generated rows. */
+  size_t scale_{100};
+  /** Frames of the buffer pool that generates the tables. */
+  size_t load_pool_size_{128};
+  /** Frames of the buffer pool that scans the tables, far fewer than the tables have pages. */
+  size_t scan_pool_size_{16};
+  /** Number of times all tables are scanned. */
+  size_t num_scans_{5};
+};
+
+auto UsageMessage() -> std::string {
+  return "usage: bustub-compression-bench [--file <path>] [--scale <n>] [--load-pool-size <frames>]\n"
+         "                                [--scan-pool-size <frames>] [--scans <n>]\n"
+         "Generates the test tables of TableGenerator, fills each one up to <scale> times its rows, and flushes them\n"
+         "to a database file, once through DiskManager and once through CompressedDiskManager. Reports the size of\n"
+         "the file, then scans all tables <scans> times through a buffer pool of <scan-pool-size> frames and reports\n"
+         "the scan throughput. Before each scan the file is dropped from the OS page cache, so the pages are read\n"
+         "from the device, as far as the file system honors the request.\n";
+}
+
+auto ParseArgs(int argc, char **argv, BenchConfig *config) -> bool {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    if (strcmp(argv[i], "--file") == 0) {
+      config->db_file_ = argv[i + 1];
+      i++;
+      continue;
+    }
+    auto value = std::stoul(argv[i + 1]);
+    if (strcmp(argv[i], "--scale") == 0) {
+      config->scale_ = value;
+    } else if (strcmp(argv[i], "--load-pool-size") == 0) {
+      config->load_pool_size_ = value;
+    } else if (strcmp(argv[i], "--scan-pool-size") == 0) {
+      config->scan_pool_size_ = value;
+    } else if (strcmp(argv[i], "--scans") == 0) {
+      config->num_scans_ = value;
+    } else {
+      return false;
+    }
+    i++;
+  }
+  return config->scale_ > 0 && config->load_pool_size_ > 0 && config->scan_pool_size_ > 0 && config->num_scans_ > 0;
+}
+
+struct BenchResult {
+  size_t num_tuples_;
+  size_t num_pages_;
+  size_t file_size_;
+  double tuples_per_sec_;
+  double pages_per_sec_;
+};
+
+auto FileSize(const std::string &file_name) -> size_t {
+  struct stat stat_buf;
+  return stat(file_name.c_str(), &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+}
+
+/** Ask the OS to drop the cached pages of the file, so that the next scan reads them from the device. */
+void DropFromPageCache(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/**
+ * Generate the tables through the disk manager, flush them and scan them.
+ * @return the number of tuples and pages of the tables, the size of the file and the scan throughput
+ */
+auto RunBench(const BenchConfig &config, DiskManager *disk_manager) -> BenchResult {
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager);
+  std::vector<page_id_t> first_page_ids;
+  BenchResult result{};
+  {
+    BufferPoolManagerInstance bpm(config.load_pool_size_, disk_manager);
+    Catalog catalog(&bpm, &lock_manager, nullptr);
+    auto txn = txn_manager.Begin();
+    ExecutorContext exec_ctx(txn, &catalog, &bpm, &txn_manager, &lock_manager);
+    TableGenerator generator(&exec_ctx);
+    generator.GenerateTestTables();
+
+    // The generated tables are small, repeat their rows until they span many pages.
+    for (const auto &name : catalog.GetTableNames()) {
+      auto table = catalog.GetTable(name)->table_.get();
+      std::vector<Tuple> tuples;
+      for (auto it = table->Begin(txn); it != table->End(); ++it) {
+        tuples.push_back(*it);
+      }
+      for (size_t round = 1; round < config.scale_; round++) {
+        for (const auto &tuple : tuples) {
+          bustub::RID rid;
+          table->InsertTuple(tuple, &rid, txn);
+        }
+      }
+      first_page_ids.push_back(table->GetFirstPageId());
+    }
+    txn_manager.Commit(txn);
+    delete txn;
+    bpm.FlushAllPages();
+  }
+  result.num_pages_ = disk_manager->GetNumAllocatedPages();
+  result.file_size_ = FileSize(config.db_file_);
+
+  // A buffer pool much smaller than the tables, so every scan reads the pages through the disk manager.
+  BufferPoolManagerInstance bpm(config.scan_pool_size_, disk_manager);
+  auto txn = txn_manager.Begin();
+  std::chrono::duration<double> elapsed{0};
+  for (size_t scan = 0; scan < config.num_scans_; scan++) {
+    DropFromPageCache(config.db_file_);
+    size_t num_tuples = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto first_page_id : first_page_ids) {
+      TableHeap table(&bpm, &lock_manager, nullptr, first_page_id);
+      for (auto it = table.Begin(txn); it != table.End(); ++it) {
+        num_tuples++;
+      }
+    }
+    elapsed += std::chrono::steady_clock::now() - start;
+    result.num_tuples_ = num_tuples;
+  }
+  txn_manager.Commit(txn);
+  delete txn;
+  const auto num_scans = static_cast<double>(config.num_scans_);
+  result.tuples_per_sec_ = static_cast<double>(result.num_tuples_) * num_scans / elapsed.count();
+  result.pages_per_sec_ = static_cast<double>(result.num_pages_) * num_scans / elapsed.count();
+  return result;
+}
+
+void RemoveFiles(const std::string &db_file) {
+  std::remove(db_file.c_str());
+  // The disk managers also create a log file next to the database file.
+  auto dot = db_file.rfind('.');
+  std::remove((db_file.substr(0, dot) + ".log").c_str());
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  BenchConfig config;
+  if (!ParseArgs(argc, argv, &config)) {
+    std::cerr << UsageMessage();
+    return 1;
+  }
+
+  fmt::print("file={} scale={} load_pool={} scan_pool={} scans={}\n", config.db_file_, config.scale_,
+             config.load_pool_size_, config.scan_pool_size_, config.num_scans_);
+  fmt::print("{:>14} {:>10} {:>8} {:>14} {:>14} {:>12}\n", "disk manager", "tuples", "pages", "file bytes",
+             "tuples/s", "pages/s");
+  for (bool compressed : {false, true}) {
+    RemoveFiles(config.db_file_);
+    std::unique_ptr<DiskManager> disk_manager;
+    if (compressed) {
+      disk_manager = std::make_unique<CompressedDiskManager>(config.db_file_);
+    } else {
+      disk_manager = std::make_unique<DiskManager>(config.db_file_);
+    }
+    auto result = RunBench(config, disk_manager.get());
+    disk_manager->ShutDown();
+    fmt::print("{:>14} {:>10} {:>8} {:>14} {:>14.0f} {:>12.0f}\n", compressed ? "compressed" : "plain",
+               result.num_tuples_, result.num_pages_, result.file_size_, result.tuples_per_sec_,
+               result.pages_per_sec_);
+  }
+  RemoveFiles(config.db_file_);
+  return 0;
+}
@@ -0,0 +1,264 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_bench.cpp
+//
+// Identification: tools/disk_bench/disk_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "fmt/core.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/disk_manager.h"
+
+using bustub::AsyncDiskManager;
+using bustub::BUSTUB_PAGE_SIZE;
+using bustub::Crc32c;
+using bustub::DiskManager;
+using bustub::page_id_t;
+
+namespace {
+
+struct BenchConfig {
+  /** Database file to create for the run; it is removed afterwards. */
+  std::string db_file_{"disk_bench.db"};
+  /** Number of pages in the file. */
+  size_t num_pages_{16384};
+  /** Largest thread count to measure; thread counts double from 1 up to this. */
+  size_t max_threads_{16};
+  /** Largest queue depth to measure with AsyncDiskManager; queue depths double from 1 up to this. 0 skips it. */
+  size_t max_queue_depth_{64};
+  /** How long each data point runs. */
+  std::chrono::milliseconds duration_{1000};
+};
+
+auto UsageMessage() -> std::string {
+  return "usage: bustub-disk-bench [--file <path>] [--pages <pages>] [--max-threads <n>] [--max-queue-depth <n>]\n"
+         "                         [--duration <ms>]\n"
+         "Writes a database file of <pages> pages, then measures random page reads per second through DiskManager\n"
+         "with 1 up to max-threads threads, and through AsyncDiskManager from a single thread that keeps 1 up to\n"
+         "max-queue-depth reads in flight. Then compares page writes and reads from one thread with and without page\n"
+         "checksums, and reports the cost of a checksum. Unless the file is larger than memory, the reads are served\n"
+         "from the OS page cache, so this measures the overhead and the concurrency of the I/O path rather than the\n"
+         "device, and the share of the checksums is an upper bound.\n";
+}
+
+auto ParseArgs(int argc, char **argv, BenchConfig *config) -> bool {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    if (strcmp(argv[i], "--file") == 0) {
+      config->db_file_ = argv[i + 1];
+      i++;
+      continue;
+    }
+    auto value = std::stoul(argv[i + 1]);
+    if (strcmp(argv[i], "--pages") == 0) {
+      config->num_pages_ = value;
+    } else if (strcmp(argv[i], "--max-threads") == 0) {
+      config->max_threads_ = value;
+    } else if (strcmp(argv[i], "--max-queue-depth") == 0) {
+      config->max_queue_depth_ = value;
+    } else if (strcmp(argv[i], "--duration") == 0) {
+      config->duration_ = std::chrono::milliseconds(value);
+    } else {
+      return false;
+    }
+    i++;
+  }
+  return config->num_pages_ > 0 && config->max_threads_ > 0;
+}
+
+/** Check that a page read back holds what the setup wrote into it. */
+void CheckPage(page_id_t page_id, const char *page) {
+  page_id_t stored;
+  memcpy(&stored, page, sizeof(stored));
+  if (stored != page_id) {
+    throw std::runtime_error(fmt::format("page {} holds data of page {}", page_id, stored));
+  }
+}
+
+/** Random page reads from all threads. @return reads per second over all threads */
+auto RunRandomReads(DiskManager *disk_manager, size_t num_pages, size_t num_threads,
+                    std::chrono::milliseconds duration) -> double {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_reads{0};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages - 1));
+      std::vector<char> page(BUSTUB_PAGE_SIZE);
+      uint64_t reads = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto page_id = dist(gen);
+        disk_manager->ReadPage(page_id, page.data());
+        CheckPage(page_id, page.data());
+        reads++;
+      }
+      total_reads += reads;
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(total_reads.load()) / elapsed.count();
+}
+
+/** Rewrite every page once, in page id order, from one thread. @return writes per second */
+auto RunWrites(DiskManager *disk_manager, size_t num_pages) -> double {
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    memcpy(page.data(), &page_id, sizeof(page_id));
+    disk_manager->WritePage(page_id, page.data());
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_pages) / elapsed.count();
+}
+
+/** @return the time to compute and store the checksum of a page, in nanoseconds */
+auto MeasureChecksumNanos() -> double {
+  constexpr size_t num_checksums = 100000;
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  std::mt19937 gen(0);
+  for (auto &byte : page) {
+    byte = static_cast<char>(gen());
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_checksums; i++) {
+    page[0] = static_cast<char>(i);
+    DiskManager::SetPageChecksum(page.data());
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / num_checksums;
+}
+
+/** Random page reads from one thread that keeps queue_depth of them in flight. @return reads per second */
+auto RunAsyncReads(AsyncDiskManager *disk_manager, size_t num_pages, size_t queue_depth,
+                   std::chrono::milliseconds duration) -> double {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages - 1));
+  std::vector<char> pages(queue_depth * BUSTUB_PAGE_SIZE);
+  std::vector<page_id_t> page_ids(queue_depth);
+  std::vector<std::future<void>> reads(queue_depth);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < queue_depth; i++) {
+    page_ids[i] = dist(gen);
+    reads[i] = disk_manager->ReadPageAsync(page_ids[i], &pages[i * BUSTUB_PAGE_SIZE]);
+  }
+  // Reap the slots round-robin and refill each one right away, so that queue_depth reads stay in flight.
+  uint64_t total_reads = 0;
+  const auto end = start + duration;
+  for (size_t i = 0;; i = (i + 1) % queue_depth) {
+    reads[i].get();
+    CheckPage(page_ids[i], &pages[i * BUSTUB_PAGE_SIZE]);
+    total_reads++;
+    if (std::chrono::steady_clock::now() >= end) {
+      break;
+    }
+    page_ids[i] = dist(gen);
+    reads[i] = disk_manager->ReadPageAsync(page_ids[i], &pages[i * BUSTUB_PAGE_SIZE]);
+  }
+  for (auto &read : reads) {
+    if (read.valid()) {
+      read.get();
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(total_reads) / elapsed.count();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  BenchConfig config;
+  if (!ParseArgs(argc, argv, &config)) {
+    std::cerr << UsageMessage();
+    return 1;
+  }
+
+  // The pages are written with checksums, so that they pass the reads that check them below.
+  auto disk_manager = std::make_unique<DiskManager>(config.db_file_, false, true);
+  std::vector<char> page(BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < config.num_pages_; i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    memcpy(page.data(), &page_id, sizeof(page_id));
+    disk_manager->WritePage(page_id, page.data());
+  }
+  disk_manager->SyncPages();
+
+  fmt::print("file={} pages={} duration={}ms\n", config.db_file_, config.num_pages_, config.duration_.count());
+  fmt::print("{:>8} {:>16}\n", "threads", "reads/s");
+  for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+    auto reads = RunRandomReads(disk_manager.get(), config.num_pages_, num_threads, config.duration_);
+    fmt::print("{:>8} {:>16.0f}\n", num_threads, reads);
+  }
+
+  disk_manager->ShutDown();
+
+  if (config.max_queue_depth_ > 0) {
+    auto async_disk_manager =
+        std::make_unique<AsyncDiskManager>(config.db_file_, static_cast<uint32_t>(config.max_queue_depth_));
+    fmt::print("\nAsyncDiskManager, one thread ({})\n", async_disk_manager->IsAsync() ? "io_uring" : "no io_uring");
+    fmt::print("{:>8} {:>16}\n", "depth", "reads/s");
+    for (size_t queue_depth = 1; queue_depth <= config.max_queue_depth_; queue_depth *= 2) {
+      auto reads = RunAsyncReads(async_disk_manager.get(), config.num_pages_, queue_depth, config.duration_);
+      fmt::print("{:>8} {:>16.0f}\n", queue_depth, reads);
+    }
+    async_disk_manager->ShutDown();
+  }
+
+  fmt::print("\npage checksums, one thread (CRC-32C with {})\n", Crc32c::IsHardwareAccelerated() ? "sse4.2" : "tables");
+  fmt::print("{:>10} {:>16} {:>16}\n", "checksums", "writes/s", "reads/s");
+  double plain_reads = 0;
+  double plain_writes = 0;
+  for (bool page_checksums : {false, true}) {
+    auto checked_disk_manager = std::make_unique<DiskManager>(config.db_file_, false, page_checksums);
+    // The writes come first, so that the pages carry checksums again when the reads check them.
+    auto writes = RunWrites(checked_disk_manager.get(), config.num_pages_);
+    auto reads = RunRandomReads(checked_disk_manager.get(), config.num_pages_, 1, config.duration_);
+    if (auto failures = checked_disk_manager->GetNumChecksumFailures(); failures != 0) {
+      throw std::runtime_error(fmt::format("{} pages failed their checksum", failures));
+    }
+    checked_disk_manager->ShutDown();
+    fmt::print("{:>10} {:>16.0f} {:>16.0f}\n", page_checksums ? "on" : "off", writes, reads);
+    if (!page_checksums) {
+      plain_writes = writes;
+      plain_reads = reads;
+    }
+  }
+  // The share of a checksum in the time of a page I/O without checksums.
+  const double checksum_nanos = MeasureChecksumNanos();
+  fmt::print("checksum {:.0f} ns per page: {:.1f}% of a write, {:.1f}% of a read\n", checksum_nanos,
+             checksum_nanos * plain_writes / 1e7, checksum_nanos * plain_reads / 1e7);
+
+  std::remove(config.db_file_.c_str());
+  // DiskManager also creates a log file next to the database file.
+  auto dot = config.db_file_.rfind('.');
+  std::remove((config.db_file_.substr(0, dot) + ".log").c_str());
+  return 0;
+}
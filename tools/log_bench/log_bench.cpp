@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_bench.cpp
+//
+// Identification: tools/log_bench/log_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+using bustub::Column;
+using bustub::DiskManager;
+using bustub::LockManager;
+using bustub::LogManager;
+using bustub::LogRecord;
+using bustub::LogRecordType;
+using bustub::RID;
+using bustub::Schema;
+using bustub::TransactionManager;
+using bustub::Tuple;
+using bustub::TypeId;
+using bustub::ValueFactory;
+
+namespace {
+
+struct BenchConfig {
+  /** Database file of the run; the log goes next to it. Both are removed afterwards. */
+  std::string db_file_{"log_bench.db"};
+  /** Largest thread count to measure; thread counts double from 1 up to this. */
+  size_t max_threads_{32};
+  /** How long each data point runs. */
+  std::chrono::milliseconds duration_{1000};
+  /** Bytes of tuple data in each logged insert. */
+  size_t tuple_size_{64};
+  /** Whether to measure bare appends, or transactions that log one insert and commit. */
+  bool commit_mode_{false};
+  /** Whether the commits in commit mode wait until their COMMIT record is on disk. */
+  bool synchronous_commit_{true};
+};
+
+auto UsageMessage() -> std::string {
+  return "usage: bustub-log-bench [--file <path>] [--max-threads <n>] [--duration <ms>] [--tuple-size <bytes>]\n"
+         "                        [--mode append|commit|async-commit]\n"
+         "Measures the throughput of LogManager::AppendLogRecord from 1 up to max-threads threads, each appending\n"
+         "insert records with <tuple-size> bytes of tuple data, while the flush thread writes the log to the log file\n"
+         "next to <path>. In commit mode, each thread runs transactions that log one insert and commit, and a commit\n"
+         "waits until its COMMIT record is on disk. In async-commit mode, a commit returns as soon as its COMMIT\n"
+         "record is in the log buffer.\n";
+}
+
+auto ParseArgs(int argc, char **argv, BenchConfig *config) -> bool {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    if (strcmp(argv[i], "--file") == 0) {
+      config->db_file_ = argv[i + 1];
+      i++;
+      continue;
+    }
+    if (strcmp(argv[i], "--mode") == 0) {
+      const std::string mode = argv[i + 1];
+      if (mode != "append" && mode != "commit" && mode != "async-commit") {
+        return false;
+      }
+      config->commit_mode_ = mode != "append";
+      config->synchronous_commit_ = mode != "async-commit";
+      i++;
+      continue;
+    }
+    auto value = std::stoul(argv[i + 1]);
+    if (strcmp(argv[i], "--max-threads") == 0) {
+      config->max_threads_ = value;
+    } else if (strcmp(argv[i], "--duration") == 0) {
+      config->duration_ = std::chrono::milliseconds(value);
+    } else if (strcmp(argv[i], "--tuple-size") == 0) {
+      config->tuple_size_ = value;
+    } else {
+      return false;
+    }
+    i++;
+  }
+  return config->max_threads_ > 0 && config->tuple_size_ > 0 && config->tuple_size_ < bustub::BUSTUB_PAGE_SIZE;
+}
+
+void RemoveFiles(const std::string &db_file) {
+  std::remove(db_file.c_str());
+  auto dot = db_file.rfind('.');
+  std::remove((db_file.substr(0, dot) + ".log").c_str());
+}
+
+struct AppendResult {
+  double appends_per_sec_;
+  double mb_per_sec_;
+  int num_flushes_;
+};
+
+/** Run num_threads threads that append insert records for the duration. */
+auto RunAppends(const BenchConfig &config, size_t num_threads) -> AppendResult {
+  RemoveFiles(config.db_file_);
+  DiskManager disk_manager(config.db_file_);
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, static_cast<uint32_t>(config.tuple_size_)}}};
+  const Tuple tuple{{ValueFactory::GetVarcharValue(std::string(config.tuple_size_, 'x'))}, &schema};
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> num_appends{0};
+  std::atomic<size_t> num_bytes{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      size_t appends = 0;
+      size_t bytes = 0;
+      bustub::lsn_t prev_lsn = bustub::INVALID_LSN;
+      while (!stop.load(std::memory_order_relaxed)) {
+        LogRecord log_record(static_cast<bustub::txn_id_t>(t), prev_lsn, LogRecordType::INSERT,
+                             RID(0, static_cast<uint32_t>(appends)), tuple);
+        prev_lsn = log_manager.AppendLogRecord(&log_record);
+        appends++;
+        bytes += log_record.GetSize();
+      }
+      num_appends += appends;
+      num_bytes += bytes;
+    });
+  }
+  std::this_thread::sleep_for(config.duration_);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+  RemoveFiles(config.db_file_);
+  return {static_cast<double>(num_appends) / elapsed.count(),
+          static_cast<double>(num_bytes) / elapsed.count() / (1024 * 1024), disk_manager.GetNumFlushes()};
+}
+
+struct CommitResult {
+  double commits_per_sec_;
+  size_t num_commits_;
+  int num_flushes_;
+};
+
+/** Run num_threads threads that each commit one transaction after another for the duration. */
+auto RunCommits(const BenchConfig &config, size_t num_threads) -> CommitResult {
+  RemoveFiles(config.db_file_);
+  DiskManager disk_manager(config.db_file_);
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, static_cast<uint32_t>(config.tuple_size_)}}};
+  const Tuple tuple{{ValueFactory::GetVarcharValue(std::string(config.tuple_size_, 'x'))}, &schema};
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> num_commits{0};
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      size_t commits = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto *txn = txn_manager.Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, config.synchronous_commit_);
+        LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT,
+                             RID(0, static_cast<uint32_t>(commits)), tuple);
+        txn->SetPrevLSN(log_manager.AppendLogRecord(&log_record));
+        txn_manager.Commit(txn);
+        delete txn;
+        commits++;
+      }
+      num_commits += commits;
+    });
+  }
+  std::this_thread::sleep_for(config.duration_);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  const int num_flushes = disk_manager.GetNumFlushes();
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+  RemoveFiles(config.db_file_);
+  return {static_cast<double>(num_commits) / elapsed.count(), num_commits, num_flushes};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  BenchConfig config;
+  if (!ParseArgs(argc, argv, &config)) {
+    std::cerr << UsageMessage();
+    return 1;
+  }
+
+  fmt::print("file={} duration={}ms tuple_size={} log_buffer={} synchronous_commit={}\n", config.db_file_,
+             config.duration_.count(), config.tuple_size_, bustub::LOG_BUFFER_SIZE,
+             config.synchronous_commit_ ? "on" : "off");
+  if (config.commit_mode_) {
+    fmt::print("{:>8} {:>14} {:>10} {:>18}\n", "threads", "commits/s", "flushes", "commits/flush");
+    for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+      auto result = RunCommits(config, num_threads);
+      fmt::print("{:>8} {:>14.0f} {:>10} {:>18.1f}\n", num_threads, result.commits_per_sec_, result.num_flushes_,
+                 static_cast<double>(result.num_commits_) / std::max(result.num_flushes_, 1));
+    }
+    return 0;
+  }
+  fmt::print("{:>8} {:>14} {:>10} {:>10}\n", "threads", "appends/s", "MB/s", "flushes");
+  for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+    auto result = RunAppends(config, num_threads);
+    fmt::print("{:>8} {:>14.0f} {:>10.1f} {:>10}\n", num_threads, result.appends_per_sec_, result.mb_per_sec_,
+               result.num_flushes_);
+  }
+  return 0;
+}
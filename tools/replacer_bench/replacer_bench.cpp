@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_bench.cpp
+//
+// Identification: tools/replacer_bench/replacer_bench.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "fmt/core.h"
+
+using bustub::frame_id_t;
+using bustub::LRUKReplacer;
+
+namespace {
+
+struct BenchConfig {
+  /** Smallest number of frames to measure; frame counts grow tenfold up to max_frames. */
+  size_t min_frames_{1000};
+  /** Largest number of frames to measure. */
+  size_t max_frames_{1000000};
+  /** Number of operations per data point. */
+  size_t ops_{1000000};
+  /** Lookback constant of the replacer. */
+  size_t k_{bustub::LRUK_REPLACER_K};
+};
+
+auto UsageMessage() -> std::string {
+  return "usage: bustub-replacer-bench [--min-frames <n>] [--max-frames <n>] [--ops <n>] [--k <k>]\n"
+         "Measures the cost of LRU-K replacer operations for frame counts growing tenfold from min-frames to\n"
+         "max-frames. A hit pins and unpins a random frame and records an access to it, the way the buffer pool does\n"
+         "on a hit; a miss evicts a frame and records the first access of its new page.\n";
+}
+
+auto ParseArgs(int argc, char **argv, BenchConfig *config) -> bool {
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+    auto value = std::stoul(argv[i + 1]);
+    if (strcmp(argv[i], "--min-frames") == 0) {
+      config->min_frames_ = value;
+    } else if (strcmp(argv[i], "--max-frames") == 0) {
+      config->max_frames_ = value;
+    } else if (strcmp(argv[i], "--ops") == 0) {
+      config->ops_ = value;
+    } else if (strcmp(argv[i], "--k") == 0) {
+      config->k_ = value;
+    } else {
+      return false;
+    }
+    i++;
+  }
+  return config->min_frames_ > 0 && config->min_frames_ <= config->max_frames_ && config->k_ > 0;
+}
+
+/** Fill the replacer with num_frames evictable frames, each with a full history. */
+void Warmup(LRUKReplacer *replacer, size_t num_frames, size_t k) {
+  for (size_t round = 0; round < k; round++) {
+    for (size_t i = 0; i < num_frames; i++) {
+      replacer->RecordAccess(static_cast<frame_id_t>(i));
+    }
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer->SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+}
+
+/** @return nanoseconds per operation */
+template <typename Op>
+auto Measure(size_t ops, Op op) -> double {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; i++) {
+    op();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / static_cast<double>(ops);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  BenchConfig config;
+  if (!ParseArgs(argc, argv, &config)) {
+    std::cerr << UsageMessage();
+    return 1;
+  }
+
+  fmt::print("k={} ops={}\n", config.k_, config.ops_);
+  fmt::print("{:>10} {:>12} {:>12}\n", "frames", "hit ns/op", "miss ns/op");
+  for (size_t num_frames = config.min_frames_; num_frames <= config.max_frames_; num_frames *= 10) {
+    auto replacer = std::make_unique<LRUKReplacer>(num_frames, config.k_);
+    Warmup(replacer.get(), num_frames, config.k_);
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<frame_id_t> dist(0, static_cast<frame_id_t>(num_frames - 1));
+    auto hit_ns = Measure(config.ops_, [&] {
+      auto frame_id = dist(gen);
+      replacer->SetEvictable(frame_id, false);
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, true);
+    });
+    auto miss_ns = Measure(config.ops_, [&] {
+      frame_id_t frame_id;
+      replacer->Evict(&frame_id);
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, true);
+    });
+    fmt::print("{:>10} {:>12.1f} {:>12.1f}\n", num_frames, hit_ns, miss_ns);
+  }
+  return 0;
+}
@@ -8,14 +8,17 @@
 
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
-
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
   bool use_emoji_prompt = false;
   bool disable_tty = false;
+  bool warm_restart = false;
 
   for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--warm-restart") == 0) {
+      warm_restart = true;
+      continue;
+    }
     if (strcmp(argv[i], "--emoji-prompt") == 0) {
       use_emoji_prompt = true;
       break;
@@ -26,6 +29,8 @@ auto main(int argc, char **argv) -> int {
     }
   }
 
+  auto bustub = std::make_unique<bustub::BustubInstance>("test.db", 1, warm_restart);
+
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {